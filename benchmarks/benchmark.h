@@ -0,0 +1,241 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// A minimal, self-contained benchmark harness.
+//
+// Every benchmark is a function that receives a State and runs its body
+// State::iterations() times. The harness picks the number of iterations
+// so that each measurement runs for a reasonable amount of time and
+// reports the best of several repetitions, which is the most stable
+// number on a noisy machine.
+//
+// Usage: <benchmark> [--json <file>] [filter]
+//
+// With --json, the results are also written to the file as JSON, so they
+// can be compared between builds and releases.
+namespace KDBindingsBenchmark {
+
+// Prevents the compiler from optimizing away the computation of value.
+#if defined(_MSC_VER) && !defined(__clang__)
+inline void useCharPointer(char const volatile *) { }
+
+template<typename T>
+inline void doNotOptimize(T const &value)
+{
+    useCharPointer(&reinterpret_cast<char const volatile &>(value));
+    _ReadWriteBarrier();
+}
+#else
+template<typename T>
+inline void doNotOptimize(T const &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+#endif
+
+class State
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit State(uint64_t iterations)
+        : m_iterations(iterations)
+    {
+    }
+
+    uint64_t iterations() const { return m_iterations; }
+
+    // Setup and teardown work inside a benchmark can be excluded from
+    // the measurement by surrounding it with pauseTiming/resumeTiming.
+    void pauseTiming()
+    {
+        m_elapsed += Clock::now() - m_start;
+    }
+
+    void resumeTiming()
+    {
+        m_start = Clock::now();
+    }
+
+private:
+    friend class Runner;
+
+    void start()
+    {
+        m_elapsed = Clock::duration::zero();
+        m_start = Clock::now();
+    }
+
+    Clock::duration stop()
+    {
+        pauseTiming();
+        return m_elapsed;
+    }
+
+    uint64_t m_iterations;
+    Clock::time_point m_start;
+    Clock::duration m_elapsed = Clock::duration::zero();
+};
+
+struct Result {
+    std::string name;
+    uint64_t iterations = 0;
+    double nanosecondsPerIteration = 0;
+};
+
+class Runner
+{
+public:
+    using Benchmark = std::function<void(State &)>;
+
+    // Only runs the benchmarks whose name contains the filter, if a filter is given.
+    explicit Runner(int argc = 0, char **argv = nullptr)
+    {
+        if (argc > 0 && argv) {
+            m_executable = argv[0];
+        }
+        for (int i = 1; i < argc && argv; ++i) {
+            if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+                m_jsonFile = argv[++i];
+            } else {
+                m_filter = argv[i];
+            }
+        }
+    }
+
+    void run(const std::string &name, const Benchmark &benchmark)
+    {
+        if (!m_filter.empty() && name.find(m_filter) == std::string::npos) {
+            return;
+        }
+
+        // Grow the number of iterations until a single repetition takes long enough
+        // to be measured reliably.
+        uint64_t iterations = 1;
+        for (;;) {
+            const auto elapsed = measure(benchmark, iterations);
+            if (elapsed >= s_minimumTime || iterations >= s_maximumIterations) {
+                break;
+            }
+            iterations *= 2;
+        }
+
+        auto best = std::chrono::nanoseconds::max();
+        for (int i = 0; i < s_repetitions; ++i) {
+            best = (std::min)(best, std::chrono::duration_cast<std::chrono::nanoseconds>(measure(benchmark, iterations)));
+        }
+
+        Result result{ name, iterations, static_cast<double>(best.count()) / static_cast<double>(iterations) };
+        std::printf("%-60s %12llu iterations %12.2f ns/iteration\n", result.name.c_str(), static_cast<unsigned long long>(result.iterations), result.nanosecondsPerIteration);
+        std::fflush(stdout);
+        m_results.push_back(std::move(result));
+    }
+
+    const std::vector<Result> &results() const { return m_results; }
+
+    // Writes the results to the file given with --json, if any.
+    // Returns the exit code for main.
+    int finish() const
+    {
+        if (m_jsonFile.empty()) {
+            return 0;
+        }
+
+        std::FILE *file = std::fopen(m_jsonFile.c_str(), "w");
+        if (!file) {
+            std::fprintf(stderr, "Could not open %s for writing\n", m_jsonFile.c_str());
+            return 1;
+        }
+        std::fprintf(file, "{\n  \"context\": {\n");
+        std::fprintf(file, "    \"executable\": \"%s\",\n", jsonEscaped(m_executable).c_str());
+        std::fprintf(file, "    \"compiler\": \"%s\",\n", jsonEscaped(compiler()).c_str());
+#ifdef NDEBUG
+        std::fprintf(file, "    \"assertions\": false\n");
+#else
+        std::fprintf(file, "    \"assertions\": true\n");
+#endif
+        std::fprintf(file, "  },\n  \"benchmarks\": [");
+        for (std::size_t i = 0; i < m_results.size(); ++i) {
+            const auto &result = m_results[i];
+            std::fprintf(file, "%s    { \"name\": \"%s\", \"iterations\": %llu, \"nsPerIteration\": %.3f }",
+                         i == 0 ? "\n" : ",\n",
+                         jsonEscaped(result.name).c_str(),
+                         static_cast<unsigned long long>(result.iterations),
+                         result.nanosecondsPerIteration);
+        }
+        std::fprintf(file, "%s]\n}\n", m_results.empty() ? "" : "\n  ");
+        const bool failed = std::ferror(file) != 0;
+        if (std::fclose(file) != 0 || failed) {
+            std::fprintf(stderr, "Could not write %s\n", m_jsonFile.c_str());
+            return 1;
+        }
+        return 0;
+    }
+
+private:
+    static std::string compiler()
+    {
+#if defined(__clang__)
+        return "clang " __clang_version__;
+#elif defined(__GNUC__)
+        return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+        return "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+        return "unknown";
+#endif
+    }
+
+    static std::string jsonEscaped(const std::string &text)
+    {
+        std::string result;
+        for (const char c : text) {
+            if (c == '"' || c == '\\') {
+                result += '\\';
+            }
+            result += c;
+        }
+        return result;
+    }
+
+    static State::Clock::duration measure(const Benchmark &benchmark, uint64_t iterations)
+    {
+        State state(iterations);
+        state.start();
+        benchmark(state);
+        return state.stop();
+    }
+
+    static constexpr std::chrono::milliseconds s_minimumTime{ 50 };
+    static constexpr uint64_t s_maximumIterations = uint64_t(1) << 30;
+    static constexpr int s_repetitions = 5;
+
+    std::string m_executable;
+    std::string m_filter;
+    std::string m_jsonFile;
+    std::vector<Result> m_results;
+};
+
+} // namespace KDBindingsBenchmark
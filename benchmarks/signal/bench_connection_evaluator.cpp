@@ -0,0 +1,175 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include <kdbindings/connection_evaluator.h>
+#include <kdbindings/lock_free_connection_evaluator.h>
+#include <kdbindings/parallel_connection_evaluator.h>
+#include <kdbindings/signal.h>
+
+#include <benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace KDBindings;
+using namespace KDBindingsBenchmark;
+
+namespace {
+
+// Some work per deferred slot, so that evaluating the queue takes a noticeable amount of time.
+void slotWork(int value, int64_t &sum)
+{
+    for (int i = 0; i < 16; ++i) {
+        sum += value ^ i;
+        doNotOptimize(sum);
+    }
+}
+
+// Emits state.iterations() times on each of the given number of producer threads, each with its own Signal,
+// while another thread keeps evaluating the deferred connections.
+// The result is the wall-clock time per emit on a single producer thread, so perfect scaling
+// shows up as the same number for every producer count.
+void runProducers(State &state, unsigned producerCount, const std::shared_ptr<ConnectionEvaluator> &evaluator)
+{
+    state.pauseTiming();
+    int64_t sum = 0;
+    std::vector<Signal<int>> signals(producerCount);
+    for (auto &signal : signals) {
+        signal.connectDeferred(evaluator, [&sum](int value) { slotWork(value, sum); }).release();
+    }
+
+    std::atomic<bool> start{ false };
+    std::atomic<unsigned> ready{ 0 };
+    std::atomic<unsigned> running{ producerCount };
+    std::vector<std::thread> producers;
+    for (unsigned t = 0; t < producerCount; ++t) {
+        producers.emplace_back([&, t]() {
+            ++ready;
+            while (!start.load()) {
+                std::this_thread::yield();
+            }
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                signals[t].emit(static_cast<int>(i));
+            }
+            --running;
+        });
+    }
+    std::thread consumer([&]() {
+        while (running.load() > 0) {
+            evaluator->evaluateDeferredConnections();
+        }
+    });
+    while (ready.load() != producerCount) {
+        std::this_thread::yield();
+    }
+    state.resumeTiming();
+
+    start = true;
+    for (auto &producer : producers) {
+        producer.join();
+    }
+
+    state.pauseTiming();
+    consumer.join();
+    evaluator->evaluateDeferredConnections();
+    evaluator->evaluateDeferredConnections();
+    doNotOptimize(sum);
+    state.resumeTiming();
+}
+
+void benchmarkProducers(Runner &runner, unsigned producerCount)
+{
+    const auto suffix = std::to_string(producerCount) + " producers";
+
+    runner.run("ConnectionEvaluator/emit while evaluating/" + suffix, [producerCount](State &state) {
+        runProducers(state, producerCount, std::make_shared<ConnectionEvaluator>());
+    });
+
+    runner.run("LockFreeConnectionEvaluator(Block)/emit while evaluating/" + suffix, [producerCount](State &state) {
+        runProducers(state, producerCount, std::make_shared<LockFreeConnectionEvaluator>(4096, OverflowPolicy::Block));
+    });
+
+    runner.run("LockFreeConnectionEvaluator(Grow)/emit while evaluating/" + suffix, [producerCount](State &state) {
+        runProducers(state, producerCount, std::make_shared<LockFreeConnectionEvaluator>(4096, OverflowPolicy::Grow));
+    });
+
+    runner.run("LockFreeConnectionEvaluator(DropOldest)/emit while evaluating/" + suffix, [producerCount](State &state) {
+        runProducers(state, producerCount, std::make_shared<LockFreeConnectionEvaluator>(4096, OverflowPolicy::DropOldest));
+    });
+}
+
+// A deferred slot that does CPU-heavy work, like decoding an image.
+void heavySlotWork(int value, int64_t &result)
+{
+    int64_t sum = value;
+    for (int i = 0; i < 20000; ++i) {
+        sum = sum * 31 + i;
+        doNotOptimize(sum);
+    }
+    result += sum;
+}
+
+// Every iteration emits 4 invocations on each of 16 connections and evaluates them.
+void runHeavySlots(State &state, const std::shared_ptr<ConnectionEvaluator> &evaluator)
+{
+    constexpr int connectionCount = 16;
+    constexpr int emitCount = 4;
+
+    state.pauseTiming();
+    Signal<int> signal;
+    // Every connection has its own result, as the slots of different connections may run in parallel.
+    std::vector<int64_t> results(connectionCount);
+    for (auto &result : results) {
+        signal.connectDeferred(evaluator, [&result](int value) { heavySlotWork(value, result); }).release();
+    }
+    state.resumeTiming();
+
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+        for (int j = 0; j < emitCount; ++j) {
+            signal.emit(j);
+        }
+        evaluator->evaluateDeferredConnections();
+    }
+    doNotOptimize(results);
+}
+
+void benchmarkParallelEvaluation(Runner &runner)
+{
+    runner.run("ConnectionEvaluator/evaluate 16 connections x 4 heavy slots", [](State &state) {
+        runHeavySlots(state, std::make_shared<ConnectionEvaluator>());
+    });
+
+    const unsigned maxThreads = (std::max)(4u, std::thread::hardware_concurrency());
+    for (unsigned threadCount = 1; threadCount <= maxThreads; threadCount *= 2) {
+        runner.run("ParallelConnectionEvaluator/evaluate 16 connections x 4 heavy slots/" + std::to_string(threadCount) + " threads", [threadCount](State &state) {
+            runHeavySlots(state, std::make_shared<ParallelConnectionEvaluator>(threadCount));
+        });
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Runner runner(argc, argv);
+
+    const unsigned maxProducers = (std::max)(4u, std::thread::hardware_concurrency());
+    for (unsigned producerCount = 1; producerCount <= maxProducers; producerCount *= 2) {
+        benchmarkProducers(runner, producerCount);
+    }
+    benchmarkParallelEvaluation(runner);
+
+    return runner.finish();
+}
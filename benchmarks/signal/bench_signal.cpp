@@ -0,0 +1,668 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include <kdbindings/binding_evaluator.h>
+#include <kdbindings/connection_evaluator.h>
+#include <kdbindings/signal.h>
+#include <kdbindings/static_signal.h>
+
+#include <benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace KDBindings;
+using namespace KDBindingsBenchmark;
+
+namespace {
+
+// A typical receiver of a signal, with some state that the slots capture.
+struct Receiver {
+    void onValue(int value) { sum += value; }
+
+    int64_t sum = 0;
+    int64_t count = 0;
+};
+
+// A lambda that captures three pointers, which is too large for std::function
+// to store inline, so it needs to allocate.
+auto makeCapturingSlot(Receiver &receiver, int64_t &extra)
+{
+    int64_t *sum = &receiver.sum;
+    int64_t *count = &receiver.count;
+    int64_t *extraPtr = &extra;
+    return [sum, count, extraPtr](int value) {
+        *sum += value;
+        ++*count;
+        *extraPtr += 1;
+    };
+}
+
+void benchmarkConnect(Runner &runner)
+{
+    // Every iteration connects and disconnects again, so the cost of growing the
+    // connection storage of the Signal is not part of the measurement.
+    runner.run("Signal::connect+disconnect/std::function", [](State &state) {
+        Receiver receiver;
+        int64_t extra = 0;
+        Signal<int> signal;
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            std::function<void(int)> slot = makeCapturingSlot(receiver, extra);
+            auto handle = signal.connect(slot);
+            handle.disconnect();
+        }
+    });
+
+    runner.run("Signal::connect+disconnect/lambda", [](State &state) {
+        Receiver receiver;
+        int64_t extra = 0;
+        Signal<int> signal;
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            auto handle = signal.connect(makeCapturingSlot(receiver, extra));
+            handle.disconnect();
+        }
+    });
+
+    runner.run("Signal::connect+disconnect/member function", [](State &state) {
+        Receiver receiver;
+        Signal<int> signal;
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            auto handle = signal.connect(&Receiver::onValue, &receiver);
+            handle.disconnect();
+        }
+    });
+
+    runner.run("Signal::connectReflective+disconnect", [](State &state) {
+        int64_t sum = 0;
+        Signal<int> signal;
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            auto handle = signal.connectReflective([&sum](ConnectionHandle &, int value) { sum += value; });
+            handle.disconnect();
+        }
+    });
+
+    // The single-shot slot disconnects itself during the emit.
+    runner.run("Signal::connectSingleShot+emit", [](State &state) {
+        int64_t sum = 0;
+        Signal<int> signal;
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            signal.connectSingleShot([&sum](int value) { sum += value; }).release();
+            signal.emit(1);
+        }
+        doNotOptimize(sum);
+    });
+}
+
+constexpr uint64_t s_chunkSize = 1000;
+
+// Disconnecting is measured on its own, in chunks of connections that are made while the timer is paused.
+void benchmarkDisconnect(Runner &runner)
+{
+    runner.run("Signal::disconnect/1000 connections", [](State &state) {
+        Receiver receiver;
+        Signal<int> signal;
+        std::vector<ConnectionHandle> handles;
+        for (uint64_t done = 0; done < state.iterations();) {
+            state.pauseTiming();
+            const auto count = (std::min)(s_chunkSize, state.iterations() - done);
+            handles.clear();
+            for (uint64_t i = 0; i < count; ++i) {
+                handles.push_back(signal.connect(&Receiver::onValue, &receiver));
+            }
+            state.resumeTiming();
+            for (auto &handle : handles) {
+                handle.disconnect();
+            }
+            done += count;
+        }
+    });
+
+    runner.run("Signal::disconnectAll/1000 connections", [](State &state) {
+        Receiver receiver;
+        Signal<int> signal(pmr::new_delete_resource());
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            state.pauseTiming();
+            for (uint64_t j = 0; j < s_chunkSize; ++j) {
+                signal.connect(&Receiver::onValue, &receiver).release();
+            }
+            state.resumeTiming();
+            signal.disconnectAll();
+        }
+    });
+
+    runner.run("Signal::disconnectAll/1000 deferred connections with 1000 queued invocations", [](State &state) {
+        int64_t sum = 0;
+        auto evaluator = std::make_shared<ConnectionEvaluator>();
+        Signal<int> signal(pmr::new_delete_resource());
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            state.pauseTiming();
+            for (uint64_t j = 0; j < s_chunkSize; ++j) {
+                signal.connectDeferred(evaluator, [&sum](int value) { sum += value; }).release();
+            }
+            signal.emit(1);
+            state.resumeTiming();
+            signal.disconnectAll();
+            state.pauseTiming();
+            // Drops the invocations of the disconnected connections.
+            evaluator->evaluateDeferredConnections();
+            state.resumeTiming();
+        }
+        doNotOptimize(sum);
+    });
+
+    runner.run("Signal::disconnect/1000 deferred connections with 1000 queued invocations", [](State &state) {
+        int64_t sum = 0;
+        auto evaluator = std::make_shared<ConnectionEvaluator>();
+        Signal<int> signal;
+        std::vector<ConnectionHandle> handles;
+        for (uint64_t done = 0; done < state.iterations();) {
+            state.pauseTiming();
+            const auto count = (std::min)(s_chunkSize, state.iterations() - done);
+            handles.clear();
+            for (uint64_t i = 0; i < count; ++i) {
+                handles.push_back(signal.connectDeferred(evaluator, [&sum](int value) { sum += value; }));
+            }
+            signal.emit(1);
+            state.resumeTiming();
+            for (auto &handle : handles) {
+                handle.disconnect();
+            }
+            state.pauseTiming();
+            evaluator->evaluateDeferredConnections();
+            state.resumeTiming();
+            done += count;
+        }
+        doNotOptimize(sum);
+    });
+
+    runner.run("ScopedConnection::~ScopedConnection/1000 connections", [](State &state) {
+        Receiver receiver;
+        Signal<int> signal;
+        std::vector<ScopedConnection> connections;
+        for (uint64_t done = 0; done < state.iterations();) {
+            state.pauseTiming();
+            const auto count = (std::min)(s_chunkSize, state.iterations() - done);
+            for (uint64_t i = 0; i < count; ++i) {
+                connections.emplace_back(signal.connect(&Receiver::onValue, &receiver));
+            }
+            state.resumeTiming();
+            connections.clear();
+            done += count;
+        }
+    });
+}
+
+void benchmarkEmit(Runner &runner)
+{
+    constexpr int slotCount = 10;
+
+    runner.run("Signal::emit/10 std::function slots", [](State &state) {
+        Receiver receiver;
+        int64_t extra = 0;
+        Signal<int> signal;
+        for (int i = 0; i < slotCount; ++i) {
+            std::function<void(int)> slot = makeCapturingSlot(receiver, extra);
+            signal.connect(slot).release();
+        }
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            signal.emit(1);
+        }
+        doNotOptimize(receiver.sum);
+    });
+
+    runner.run("Signal::emit/10 lambda slots", [](State &state) {
+        Receiver receiver;
+        int64_t extra = 0;
+        Signal<int> signal;
+        for (int i = 0; i < slotCount; ++i) {
+            signal.connect(makeCapturingSlot(receiver, extra)).release();
+        }
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            signal.emit(1);
+        }
+        doNotOptimize(receiver.sum);
+    });
+
+    runner.run("Signal::emit/10 member function slots", [](State &state) {
+        Receiver receiver;
+        Signal<int> signal;
+        for (int i = 0; i < slotCount; ++i) {
+            signal.connect(&Receiver::onValue, &receiver).release();
+        }
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            signal.emit(1);
+        }
+        doNotOptimize(receiver.sum);
+    });
+
+    // Emitting a large payload to slots that take it by const reference should not copy it.
+    runner.run("Signal::emit/std::vector<int>(1000) to 10 const& slots", [](State &state) {
+        int64_t sum = 0;
+        Signal<std::vector<int>> signal;
+        for (int i = 0; i < slotCount; ++i) {
+            signal.connect([&sum](const std::vector<int> &values) { sum += values.back(); }).release();
+        }
+        const std::vector<int> payload(1000, 1);
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            signal.emit(payload);
+        }
+        doNotOptimize(sum);
+    });
+
+    runner.run("Signal::emit/std::string to 10 const& slots", [](State &state) {
+        size_t length = 0;
+        Signal<std::string> signal;
+        for (int i = 0; i < slotCount; ++i) {
+            signal.connect([&length](const std::string &value) { length += value.size(); }).release();
+        }
+        const std::string payload(256, 'x');
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            signal.emit(payload);
+        }
+        doNotOptimize(length);
+    });
+}
+
+// The same slot connected to a Signal and to a hand-written std::vector<std::function>,
+// which is the least a signal can do, to see how much overhead Signal adds.
+void benchmarkSlotCount(Runner &runner)
+{
+    for (const int slotCount : { 0, 1, 10, 1000 }) {
+        const auto slots = std::to_string(slotCount) + (slotCount == 1 ? " slot" : " slots");
+
+        runner.run("Signal::emit/" + slots, [slotCount](State &state) {
+            int64_t sum = 0;
+            Signal<int> signal;
+            for (int i = 0; i < slotCount; ++i) {
+                signal.connect([&sum](int value) { sum += value; }).release();
+            }
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                signal.emit(1);
+            }
+            doNotOptimize(sum);
+        });
+
+        runner.run("baseline/std::vector<std::function>::emit/" + slots, [slotCount](State &state) {
+            int64_t sum = 0;
+            std::vector<std::function<void(int)>> signal;
+            for (int i = 0; i < slotCount; ++i) {
+                signal.emplace_back([&sum](int value) { sum += value; });
+            }
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                for (const auto &slot : signal) {
+                    slot(1);
+                }
+            }
+            doNotOptimize(sum);
+        });
+    }
+
+    runner.run("Signal::emit/10 slots, all blocked", [](State &state) {
+        int64_t sum = 0;
+        Signal<int> signal;
+        for (int i = 0; i < 10; ++i) {
+            signal.connect([&sum](int value) { sum += value; }).block(true);
+        }
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            signal.emit(1);
+        }
+        doNotOptimize(sum);
+    });
+
+    runner.run("baseline/std::vector<std::function>::push_back+pop_back", [](State &state) {
+        int64_t sum = 0;
+        std::vector<std::function<void(int)>> signal;
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            signal.emplace_back([&sum](int value) { sum += value; });
+            signal.pop_back();
+        }
+        doNotOptimize(signal);
+    });
+}
+
+// Signals with many connections, where the memory layout of the connections matters most.
+void benchmarkManyConnections(Runner &runner)
+{
+    constexpr int connectionCount = 500;
+
+    runner.run("Signal::emit/500 member function slots", [](State &state) {
+        Receiver receiver;
+        Signal<int> signal;
+        for (int i = 0; i < connectionCount; ++i) {
+            signal.connect(&Receiver::onValue, &receiver).release();
+        }
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            signal.emit(1);
+        }
+        doNotOptimize(receiver.sum);
+    });
+
+    runner.run("Signal::emit/500 member function slots, 90% blocked", [](State &state) {
+        Receiver receiver;
+        Signal<int> signal;
+        for (int i = 0; i < connectionCount; ++i) {
+            auto handle = signal.connect(&Receiver::onValue, &receiver);
+            if (i % 10 != 0) {
+                handle.block(true);
+            }
+        }
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            signal.emit(1);
+        }
+        doNotOptimize(receiver.sum);
+    });
+
+    // Emitting should only depend on the number of connections that are still connected,
+    // not on how many connections the Signal had at some point.
+    // The single-shot slot disconnects itself, which has to be cleaned up after the emit.
+    runner.run("Signal::emit/500 member function slots + 1 single-shot slot", [](State &state) {
+        Receiver receiver;
+        Signal<int> signal;
+        for (int i = 0; i < connectionCount; ++i) {
+            signal.connect(&Receiver::onValue, &receiver).release();
+        }
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            signal.connectSingleShot([&receiver](int value) { receiver.onValue(value); }).release();
+            signal.emit(1);
+        }
+        doNotOptimize(receiver.sum);
+    });
+
+    runner.run("Signal::emit/10 slots after disconnecting 490", [](State &state) {
+        Receiver receiver;
+        Signal<int> signal;
+        std::vector<ConnectionHandle> handles;
+        for (int i = 0; i < connectionCount; ++i) {
+            handles.push_back(signal.connect(&Receiver::onValue, &receiver));
+        }
+        for (int i = 0; i < connectionCount; ++i) {
+            if (i % 50 != 0) {
+                handles[i].disconnect();
+            }
+        }
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            signal.emit(1);
+        }
+        doNotOptimize(receiver.sum);
+    });
+}
+
+// Emitting many values at once, e.g. from a sensor ingest loop.
+void benchmarkBatch(Runner &runner)
+{
+    constexpr int slotCount = 4;
+    constexpr int batchSize = 1000;
+
+    std::vector<std::tuple<int, float>> batch;
+    for (int i = 0; i < batchSize; ++i) {
+        batch.emplace_back(i, static_cast<float>(i) * 0.5f);
+    }
+
+    runner.run("Signal::emit/1000 values to 4 slots, one emit per value", [&batch](State &state) {
+        double sum = 0;
+        Signal<int, float> signal;
+        for (int i = 0; i < slotCount; ++i) {
+            signal.connect([&sum](int value, float factor) { sum += value * factor; }).release();
+        }
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            for (const auto &[value, factor] : batch) {
+                signal.emit(value, factor);
+            }
+        }
+        doNotOptimize(sum);
+    });
+
+    runner.run("Signal::emitBatch/1000 values to 4 slots", [&batch](State &state) {
+        double sum = 0;
+        Signal<int, float> signal;
+        for (int i = 0; i < slotCount; ++i) {
+            signal.connect([&sum](int value, float factor) { sum += value * factor; }).release();
+        }
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            signal.emitBatch(batch);
+        }
+        doNotOptimize(sum);
+    });
+
+    runner.run("Signal::emitBatch/1000 values to 4 batch slots", [&batch](State &state) {
+        double sum = 0;
+        Signal<int, float> signal;
+        for (int i = 0; i < slotCount; ++i) {
+            signal.connectBatch([&sum](const SignalBatch<int, float> &values) {
+                      for (const auto &[value, factor] : values) {
+                          sum += value * factor;
+                      }
+                  })
+                    .release();
+        }
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            signal.emitBatch(batch);
+        }
+        doNotOptimize(sum);
+    });
+}
+
+// Reflective and deferred connections receive a ConnectionHandle on every emit.
+void benchmarkReflectiveEmit(Runner &runner)
+{
+    constexpr int slotCount = 10;
+
+    runner.run("Signal::emit/10 reflective slots", [](State &state) {
+        int64_t sum = 0;
+        Signal<int> signal;
+        for (int i = 0; i < slotCount; ++i) {
+            signal.connectReflective([&sum](ConnectionHandle &, int value) { sum += value; }).release();
+        }
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            signal.emit(1);
+        }
+        doNotOptimize(sum);
+    });
+
+    runner.run("Signal::emit/10 deferred slots + evaluate", [](State &state) {
+        int64_t sum = 0;
+        auto evaluator = std::make_shared<ConnectionEvaluator>();
+        Signal<int> signal;
+        for (int i = 0; i < slotCount; ++i) {
+            signal.connectDeferred(evaluator, [&sum](int value) { sum += value; }).release();
+        }
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            signal.emit(1);
+            evaluator->evaluateDeferredConnections();
+        }
+        doNotOptimize(sum);
+    });
+
+    // Evaluating a part of a long queue must not depend on the length of the queue.
+    runner.run("ConnectionEvaluator::evaluateDeferredConnections/100 of 10000 queued invocations", [](State &state) {
+        int64_t sum = 0;
+        auto evaluator = std::make_shared<ConnectionEvaluator>();
+        Signal<int> signal;
+        signal.connectDeferred(evaluator, [&sum](int value) { sum += value; }).release();
+        for (int i = 0; i < 10000; ++i) {
+            signal.emit(1);
+        }
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            for (int j = 0; j < 100; ++j) {
+                signal.emit(1);
+            }
+            evaluator->evaluateDeferredConnections(100);
+        }
+        doNotOptimize(sum);
+    });
+
+    // A high-frequency signal, which is emitted 100 times between two evaluations.
+    for (auto mode : { DeferredConnectionMode::Queued, DeferredConnectionMode::Conflated }) {
+        const std::string modeName = mode == DeferredConnectionMode::Queued ? "queued" : "conflated";
+        runner.run("Signal::emit/100 emits to a " + modeName + " deferred slot + evaluate", [mode](State &state) {
+            int64_t sum = 0;
+            auto evaluator = std::make_shared<ConnectionEvaluator>();
+            Signal<int> signal;
+            signal.connectDeferred(evaluator, [&sum](int value) { sum += value; }, mode).release();
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                for (int j = 0; j < 100; ++j) {
+                    signal.emit(j);
+                }
+                evaluator->evaluateDeferredConnections();
+            }
+            doNotOptimize(sum);
+        });
+    }
+}
+
+// Copying and checking ConnectionHandles updates the reference counts of the Signal.
+// Compare bench-signal with bench-signal-single-threaded to see the cost of atomic reference counting.
+void benchmarkConnectionHandle(Runner &runner)
+{
+    runner.run("ConnectionHandle::copy", [](State &state) {
+        Signal<int> signal;
+        auto handle = signal.connect([](int) {});
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            ConnectionHandle copy(handle);
+            doNotOptimize(copy);
+        }
+    });
+
+    runner.run("ConnectionHandle::isActive", [](State &state) {
+        Signal<int> signal;
+        auto handle = signal.connect([](int) {});
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            doNotOptimize(handle.isActive());
+        }
+    });
+
+    runner.run("ConnectionHandle::belongsTo", [](State &state) {
+        Signal<int> signal;
+        auto handle = signal.connect([](int) {});
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            doNotOptimize(handle.belongsTo(signal));
+        }
+    });
+
+    runner.run("ConnectionHandle::operator==", [](State &state) {
+        Signal<int> signal;
+        auto handle = signal.connect([](int) {});
+        auto other = handle;
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            doNotOptimize(handle == other);
+        }
+    });
+
+    runner.run("Signal::blockConnection", [](State &state) {
+        Signal<int> signal;
+        auto handle = signal.connect([](int) {});
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            doNotOptimize(signal.blockConnection(handle, (i & 1) != 0));
+        }
+    });
+
+    runner.run("BindingEvaluator::copy", [](State &state) {
+        BindingEvaluator evaluator;
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            BindingEvaluator copy(evaluator);
+            doNotOptimize(copy);
+        }
+    });
+}
+
+// Signals whose receivers are known at compile time.
+void benchmarkStaticSignal(Runner &runner)
+{
+    runner.run("Signal::emit/4 member function slots", [](State &state) {
+        Receiver receiver;
+        Signal<int> signal;
+        for (int i = 0; i < 4; ++i) {
+            signal.connect(&Receiver::onValue, &receiver).release();
+        }
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            signal.emit(1);
+        }
+        doNotOptimize(receiver.sum);
+    });
+
+    runner.run("StaticSignal::emit/4 member function slots", [](State &state) {
+        Receiver receiver;
+        auto slot = [&receiver](int value) { receiver.onValue(value); };
+        auto signal = makeStaticSignal<void(int)>(slot, slot, slot, slot);
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            signal.emit(1);
+            doNotOptimize(receiver.sum);
+        }
+    });
+}
+
+constexpr int s_nestingDepth = 4;
+
+// A slot that re-emits its own signal, e.g. to propagate a change through a property graph.
+void benchmarkNestedEmit(Runner &runner)
+{
+    runner.run("Signal::emit/nested 4 levels deep", [](State &state) {
+        int64_t sum = 0;
+        Signal<int> signal;
+        signal.connect([&](int value) {
+                  sum += value;
+                  if (value > 0) {
+                      signal.emit(value - 1);
+                  }
+              })
+                .release();
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            signal.emit(s_nestingDepth);
+        }
+        doNotOptimize(sum);
+    });
+
+    // The same, but bouncing every level through a ConnectionEvaluator, which was
+    // required while nested emits were not supported.
+    runner.run("Signal::emit/4 levels through ConnectionEvaluator", [](State &state) {
+        int64_t sum = 0;
+        auto evaluator = std::make_shared<ConnectionEvaluator>();
+        Signal<int> signal;
+        signal.connectDeferred(evaluator, [&](int value) {
+                  sum += value;
+                  if (value > 0) {
+                      signal.emit(value - 1);
+                  }
+              })
+                .release();
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            signal.emit(s_nestingDepth);
+            for (int level = 0; level <= s_nestingDepth; ++level) {
+                evaluator->evaluateDeferredConnections();
+            }
+        }
+        doNotOptimize(sum);
+    });
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Runner runner(argc, argv);
+
+    benchmarkConnect(runner);
+    benchmarkDisconnect(runner);
+    benchmarkEmit(runner);
+    benchmarkSlotCount(runner);
+    benchmarkManyConnections(runner);
+    benchmarkBatch(runner);
+    benchmarkReflectiveEmit(runner);
+    benchmarkConnectionHandle(runner);
+    benchmarkStaticSignal(runner);
+    benchmarkNestedEmit(runner);
+
+    return runner.finish();
+}
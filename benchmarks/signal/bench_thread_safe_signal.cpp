@@ -0,0 +1,134 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include <kdbindings/signal.h>
+#include <kdbindings/thread_safe_signal.h>
+
+#include <benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace KDBindings;
+using namespace KDBindingsBenchmark;
+
+namespace {
+
+constexpr int s_slotCount = 4;
+
+// A Signal that is made thread-safe by locking a mutex around every operation.
+// This is what users of Signal have to do today if they emit on multiple threads.
+class MutexSignal
+{
+public:
+    template<typename Func>
+    ConnectionHandle connect(Func &&func)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_signal.connect(std::forward<Func>(func));
+    }
+
+    void emit(int value)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_signal.emit(value);
+    }
+
+private:
+    std::mutex m_mutex;
+    Signal<int> m_signal;
+};
+
+// Runs emitFunction state.iterations() times on each of the given number of threads at once.
+// The result is the wall-clock time per emit on a single thread, so perfect scaling
+// shows up as the same number for every thread count.
+template<typename EmitFunction>
+void runOnThreads(State &state, unsigned threadCount, const EmitFunction &emitFunction)
+{
+    state.pauseTiming();
+    std::atomic<bool> start{ false };
+    std::atomic<unsigned> ready{ 0 };
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&]() {
+            ++ready;
+            while (!start.load()) {
+                std::this_thread::yield();
+            }
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                emitFunction(static_cast<int>(i));
+            }
+        });
+    }
+    while (ready.load() != threadCount) {
+        std::this_thread::yield();
+    }
+    state.resumeTiming();
+
+    start = true;
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+void benchmarkEmit(Runner &runner, unsigned threadCount)
+{
+    const auto suffix = std::to_string(s_slotCount) + " slots/" + std::to_string(threadCount) + " threads";
+
+    runner.run("Signal+std::mutex::emit/" + suffix, [threadCount](State &state) {
+        MutexSignal signal;
+        for (int i = 0; i < s_slotCount; ++i) {
+            (void)signal.connect([](int value) { doNotOptimize(value); });
+        }
+        runOnThreads(state, threadCount, [&signal](int value) { signal.emit(value); });
+    });
+
+    runner.run("ThreadSafeSignal::emit/" + suffix, [threadCount](State &state) {
+        ThreadSafeSignal<int> signal;
+        for (int i = 0; i < s_slotCount; ++i) {
+            (void)signal.connect([](int value) { doNotOptimize(value); });
+        }
+        runOnThreads(state, threadCount, [&signal](int value) { signal.emit(value); });
+    });
+}
+
+void benchmarkConnect(Runner &runner)
+{
+    runner.run("ThreadSafeSignal::connect+disconnect/" + std::to_string(s_slotCount) + " slots", [](State &state) {
+        ThreadSafeSignal<int> signal;
+        for (int i = 0; i < s_slotCount; ++i) {
+            (void)signal.connect([](int value) { doNotOptimize(value); });
+        }
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            auto handle = signal.connect([](int value) { doNotOptimize(value); });
+            handle.disconnect();
+        }
+    });
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Runner runner(argc, argv);
+
+    const unsigned maxThreads = (std::max)(4u, std::thread::hardware_concurrency());
+    for (unsigned threadCount = 1; threadCount <= maxThreads; threadCount *= 2) {
+        benchmarkEmit(runner, threadCount);
+    }
+    benchmarkConnect(runner);
+
+    return runner.finish();
+}
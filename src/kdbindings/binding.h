@@ -17,6 +17,7 @@
 #include <kdbindings/make_node.h>
 #include <kdbindings/binding_evaluator.h>
 #include <kdbindings/property_updater.h>
+#include <kdbindings/tracing.h>
 
 namespace KDBindings {
 
@@ -87,6 +88,7 @@ public:
     /** Re-evaluates the value of the Binding and notifies all dependants of the change. */
     void evaluate()
     {
+        Private::TraceScope trace("binding", "Binding::evaluate", this);
         T value = m_rootNode.evaluate();
 
         // Use this to update any associated property via the PropertyUpdater's update function
@@ -183,6 +185,34 @@ inline std::unique_ptr<Binding<ResultType, EvaluatorT>> makeBinding(EvaluatorT &
     return std::make_unique<Binding<ResultType, EvaluatorT>>(Private::makeNode(std::forward<Func>(func), std::forward<Args>(args)...), evaluator);
 }
 
+/**
+ * @brief Helper function to create a Binding that is allocated from a memory resource.
+ *
+ * This takes the same arguments as the other overloads of makeBinding, preceded by std::allocator_arg
+ * and the memory resource. The Binding, as well as the Nodes that are created for a function and its
+ * arguments, are allocated from the memory resource, which must outlive the Binding.
+ *
+ * Nodes that were created before, e.g. by combining Property instances using operators,
+ * are allocated from pmr::new_delete_resource(). To place a whole expression into the memory
+ * resource, pass it as a function with its arguments instead.
+ *
+ * Example:
+ * @code
+ * auto binding = makeBinding(std::allocator_arg, &resource, evaluator, [](int a, int b) { return a + b; }, a, b);
+ * @endcode
+ *
+ * @param resource The memory resource that the Binding is allocated from.
+ * @param evaluator The evaluator that is used to evaluate the Binding.
+ * @param args A Property, a root Node, or a function with its arguments.
+ * @return std::unique_ptr<Binding<ResultType, EvaluatorT>> A new Binding that is powered by the evaluator.
+ */
+template<typename EvaluatorT, typename... Args, typename = std::enable_if_t<std::is_base_of<BindingEvaluator, EvaluatorT>::value>, typename ResultType = Private::bindable_value_type_t<decltype(Private::makeNode(std::allocator_arg, std::declval<pmr::memory_resource *>(), std::declval<Args>()...))>>
+inline std::unique_ptr<Binding<ResultType, EvaluatorT>> makeBinding(std::allocator_arg_t, pmr::memory_resource *resource, EvaluatorT &evaluator, Args &&...args)
+{
+    using BindingType = Binding<ResultType, EvaluatorT>;
+    return std::unique_ptr<BindingType>(new (resource) BindingType(Private::makeNode(std::allocator_arg, resource, std::forward<Args>(args)...), evaluator));
+}
+
 /**
  * @brief Provides a convenience for old-school, immediate mode Bindings.
  *
@@ -300,6 +330,25 @@ inline std::unique_ptr<Binding<ResultType, ImmediateBindingEvaluator>> makeBindi
     return std::make_unique<Binding<ResultType, ImmediateBindingEvaluator>>(Private::makeNode(std::forward<Func>(func), std::forward<Args>(args)...));
 }
 
+/**
+ * @brief Helper function to create an immediate mode Binding that is allocated from a memory resource.
+ *
+ * This takes the same arguments as the other overloads of makeBinding for immediate mode Bindings,
+ * preceded by std::allocator_arg and the memory resource, which must outlive the Binding.
+ * See makeBinding(std::allocator_arg_t, pmr::memory_resource *, EvaluatorT &, Args &&...) for which
+ * parts of the Binding are allocated from the memory resource.
+ *
+ * @param resource The memory resource that the Binding is allocated from.
+ * @param args A Property, a root Node, or a function with its arguments.
+ * @return std::unique_ptr<Binding<ResultType, ImmediateBindingEvaluator>> A new Binding with immediate evaluation.
+ */
+template<typename... Args, typename ResultType = Private::bindable_value_type_t<decltype(Private::makeNode(std::allocator_arg, std::declval<pmr::memory_resource *>(), std::declval<Args>()...))>>
+inline std::unique_ptr<Binding<ResultType, ImmediateBindingEvaluator>> makeBinding(std::allocator_arg_t, pmr::memory_resource *resource, Args &&...args)
+{
+    using BindingType = Binding<ResultType, ImmediateBindingEvaluator>;
+    return std::unique_ptr<BindingType>(new (resource) BindingType(Private::makeNode(std::allocator_arg, resource, std::forward<Args>(args)...)));
+}
+
 /**
  * @brief Helper function to create a Property with a Binding.
  *
@@ -311,6 +360,7 @@ inline std::unique_ptr<Binding<ResultType, ImmediateBindingEvaluator>> makeBindi
  *
  * Alternatively a BindingEvaluator can be passed as the first argument to this function to control
  * when evaluation takes place.
+ * To allocate the Binding from a memory resource, pass std::allocator_arg and the memory resource first.
  *
  * See the documentation for the various overloads of the free @ref makeBinding function for a
  * detailed description of which arguments can be used in which order.
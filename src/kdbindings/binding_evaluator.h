@@ -11,9 +11,11 @@
 
 #pragma once
 
+#include <kdbindings/memory_resource.h>
+#include <kdbindings/shared_ptr.h>
+
 #include <functional>
 #include <map>
-#include <memory>
 
 namespace KDBindings {
 
@@ -43,15 +45,35 @@ class BindingEvaluator
     // We use pimpl here so that we can pass evaluators around by value (copies)
     // yet each copy refers to the same set of data
     struct Private {
+        using EvalFunctions = std::map<int, std::function<void()>, std::less<int>,
+                                       KDBindings::Private::ResourceAllocator<std::pair<const int, std::function<void()>>>>;
+
+        explicit Private(pmr::memory_resource *resource)
+            : m_bindingEvalFunctions(resource)
+        {
+        }
+
         // TODO: Use std::vector here?
-        std::map<int, std::function<void()>> m_bindingEvalFunctions;
-        int m_currentId;
+        EvalFunctions m_bindingEvalFunctions;
+        int m_currentId = 0;
     };
 
 public:
     /** A BindingEvaluator can be default constructed */
     BindingEvaluator() = default;
 
+    /**
+     * Constructs a BindingEvaluator that allocates its collection of Bindings from the
+     * given memory resource.
+     *
+     * The memory resource must outlive the BindingEvaluator and all of its copies.
+     * Without a memory resource, pmr::new_delete_resource() is used.
+     */
+    explicit BindingEvaluator(pmr::memory_resource *resource)
+        : m_d{ KDBindings::Private::allocateShared<Private>(resource, resource) }
+    {
+    }
+
     /**
      * A BindingEvaluator can be copy constructed.
      *
@@ -109,7 +131,7 @@ private:
         m_d->m_bindingEvalFunctions.erase(id);
     }
 
-    std::shared_ptr<Private> m_d{ std::make_shared<Private>() };
+    KDBindings::Private::SharedPtr<Private> m_d{ KDBindings::Private::allocateShared<Private>(pmr::new_delete_resource(), pmr::new_delete_resource()) };
 
     template<typename T, typename UpdaterT>
     friend class Binding;
@@ -129,11 +151,21 @@ private:
 class ImmediateBindingEvaluator final : public BindingEvaluator
 {
 public:
+    ImmediateBindingEvaluator() = default;
+
     static inline ImmediateBindingEvaluator instance()
     {
-        static ImmediateBindingEvaluator evaluator;
+        // The instance lives until the end of the program, so it must not be allocated from
+        // whatever memory resource happens to be the default when it is first used.
+        static ImmediateBindingEvaluator evaluator(pmr::new_delete_resource());
         return evaluator;
     }
+
+private:
+    explicit ImmediateBindingEvaluator(pmr::memory_resource *resource)
+        : BindingEvaluator(resource)
+    {
+    }
 };
 
 } // namespace KDBindings
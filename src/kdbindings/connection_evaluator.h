@@ -11,13 +11,64 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <limits>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <string_view>
+#include <utility>
 
-#include <kdbindings/connection_handle.h>
+#include <kdbindings/genindex_array.h>
+#include <kdbindings/memory_resource.h>
+#include <kdbindings/metrics_recorder.h>
+#include <kdbindings/small_function.h>
+#include <kdbindings/tracing.h>
 
 namespace KDBindings {
 
+/**
+ * @brief Controls how a deferred connection queues its slot invocations.
+ *
+ * @see Signal::connectDeferred()
+ */
+enum class DeferredConnectionMode {
+    /** Every emit queues an invocation of the slot. */
+    Queued,
+    /**
+     * An emit only queues an invocation of the slot if the connection has no queued invocation yet.
+     * Otherwise the arguments of the queued invocation are replaced with the new ones,
+     * so the slot is only called once, with the arguments of the latest emit.
+     *
+     * This is useful for high-frequency signals, like mouse moves or value changes,
+     * where only the latest value matters.
+     */
+    Conflated,
+};
+
+/**
+ * @brief The priority of the slot invocations of a deferred connection.
+ *
+ * The queued invocations of higher priorities are evaluated before those of lower priorities.
+ * To prevent a flood of higher priority invocations from delaying lower priority invocations forever,
+ * a lower priority invocation is evaluated after ConnectionEvaluator::StarvationLimit higher priority
+ * invocations were evaluated while it waited.
+ *
+ * Invocations of the same priority are evaluated in the order in which they were queued.
+ *
+ * @see Signal::connectDeferred()
+ */
+enum class DeferredConnectionPriority {
+    High,
+    Normal,
+    Low,
+};
+
 /**
  * @brief Manages and evaluates deferred Signal connections.
  *
@@ -36,6 +87,22 @@ public:
     /** ConnectionEvaluators are default constructible */
     ConnectionEvaluator() = default;
 
+    /**
+     * Constructs a ConnectionEvaluator that allocates the queued slot invocations
+     * from the given memory resource.
+     *
+     * The memory resource must outlive the ConnectionEvaluator.
+     * Without a memory resource, pmr::new_delete_resource() is used.
+     *
+     * To allocate the ConnectionEvaluator itself from the memory resource as well, use std::allocate_shared.
+     */
+    explicit ConnectionEvaluator(pmr::memory_resource *resource)
+        : m_lanes{ { Lane(resource), Lane(resource), Lane(resource) } }
+        , m_connections(resource)
+        , m_batch(resource)
+    {
+    }
+
     /** Connectionevaluators are not copyable */
     // As it is designed to manage connections,
     // and copying it could lead to unexpected behavior, including duplication of connections and issues
@@ -59,34 +126,80 @@ public:
      * This function is responsible for evaluating and executing deferred connections.
      * This function is thread safe.
      *
+     * The invocations that are queued when the evaluation starts are taken from the queue at once,
+     * so Signals can be emitted on other threads while the slots are running, without waiting for them.
+     * Invocations that are queued in the meantime, including those queued by the slots themselves,
+     * are evaluated by the next call.
+     *
      * @warning Evaluating slots that throw an exception is currently undefined behavior.
      */
-    void evaluateDeferredConnections()
+    virtual void evaluateDeferredConnections()
     {
-        std::lock_guard<std::recursive_mutex> lock(m_slotInvocationMutex);
+        evaluateQueuedInvocations(EvaluationBudget());
+    }
 
-        if (m_isEvaluating) {
-            // We're already evaluating, so we don't want to re-enter this function.
-            return;
-        }
-        m_isEvaluating = true;
+    /**
+     * @brief Evaluate at most `maxInvocations` of the deferred connections.
+     *
+     * Evaluates the oldest queued invocations, until `maxInvocations` slots were called.
+     * The remaining invocations stay queued in order, and are evaluated by the next call.
+     * This allows an event loop to spread the evaluation of a burst of invocations over multiple iterations.
+     *
+     * This function is thread safe.
+     *
+     * @return The number of invocations that are still queued.
+     */
+    std::size_t evaluateDeferredConnections(std::size_t maxInvocations)
+    {
+        EvaluationBudget budget;
+        budget.maxInvocations = maxInvocations;
+        return evaluateQueuedInvocations(budget);
+    }
 
-        // Current best-effort error handling will remove any further invocations that were queued.
-        // We could use a queue and use a `while(!empty) { pop_front() }` loop instead to avoid this.
-        // However, we would then ideally use a ring-buffer to avoid excessive allocations, which isn't in the STL.
-        try {
-            for (auto &pair : m_deferredSlotInvocations) {
-                pair.second();
-            }
-        } catch (...) {
-            // Best-effort: Reset the ConnectionEvaluator so that it at least doesn't execute the same erroneous slot multiple times.
-            m_deferredSlotInvocations.clear();
-            m_isEvaluating = false;
-            throw;
-        }
+    /**
+     * @brief Evaluate the deferred connections until `timeBudget` has passed.
+     *
+     * Evaluates the oldest queued invocations, as long as `timeBudget` hasn't passed since this function was called.
+     * A slot that is running when the time budget runs out is not interrupted, so the evaluation may take
+     * longer than `timeBudget` by the duration of one slot.
+     * The remaining invocations stay queued in order, and are evaluated by the next call.
+     *
+     * This function is thread safe.
+     *
+     * Example:
+     * @code
+     * // Spend at most 4ms of the 16ms frame on deferred slots.
+     * const auto remaining = evaluator->evaluateFor(std::chrono::milliseconds(4));
+     * if (remaining > 0) {
+     *     scheduleAnotherFrame();
+     * }
+     * @endcode
+     *
+     * @return The number of invocations that are still queued.
+     */
+    template<typename Rep, typename Period>
+    std::size_t evaluateFor(std::chrono::duration<Rep, Period> timeBudget)
+    {
+        EvaluationBudget budget;
+        budget.deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeBudget);
+        return evaluateQueuedInvocations(budget);
+    }
 
-        m_deferredSlotInvocations.clear();
-        m_isEvaluating = false;
+    /**
+     * The number of higher priority invocations after which a waiting lower priority invocation is evaluated.
+     *
+     * @see DeferredConnectionPriority
+     */
+    static constexpr std::size_t StarvationLimit = 32;
+
+    /**
+     * Sets the name under which this ConnectionEvaluator appears in the MetricsRegistry.
+     *
+     * Does nothing unless KDBindings is built with metrics enabled (see MetricsRegistry::isEnabled()).
+     */
+    void setMetricsName(std::string_view name)
+    {
+        metricsRecorder().setName(name);
     }
 
 protected:
@@ -107,50 +220,511 @@ protected:
      */
     virtual void onInvocationAdded() { }
 
+    // The rest of the protected interface is for subclasses that store or evaluate
+    // the queued invocations differently.
+
+    // A queued invocation stores the shared slot of the deferred connection and a copy of the emitted arguments.
+    // The inline buffer is large enough for a few small arguments, so that queueing them doesn't allocate.
+    // The queue itself keeps its capacity when it is cleared, so its storage is reused by later invocations.
+    using SlotInvocation = Private::SmallFunction<void(), 8 * sizeof(void *)>;
+    using QueuedInvocation = std::pair<Private::GenerationalIndex, SlotInvocation>;
+
+    // How many invocations an evaluation with a deadline takes from the lanes at once.
+    static constexpr std::size_t DeadlineChunkSize = 64;
+
+    // Limits how many invocations evaluateQueuedInvocations may evaluate.
+    struct EvaluationBudget {
+        std::size_t maxInvocations = (std::numeric_limits<std::size_t>::max)();
+        std::optional<std::chrono::steady_clock::time_point> deadline;
+
+        bool isExpired() const noexcept
+        {
+            return deadline && std::chrono::steady_clock::now() >= *deadline;
+        }
+
+        // Whether another invocation may be evaluated, once `evaluatedInvocations` were evaluated.
+        bool allows(std::size_t evaluatedInvocations) const noexcept
+        {
+            return evaluatedInvocations < maxInvocations && !isExpired();
+        }
+    };
+
+    // Evaluates the oldest queued invocations within the budget and returns the number of invocations
+    // that are still queued.
+    //
+    // Overridden by ConnectionEvaluators that store or evaluate their invocations differently.
+    virtual std::size_t evaluateQueuedInvocations(const EvaluationBudget &budget)
+    {
+        // Other threads wait until the evaluation is done, a slot that evaluates re-enters the lock.
+        std::lock_guard<std::recursive_mutex> evaluationLock(m_evaluationMutex);
+        if (m_isEvaluating) {
+            // We're already evaluating, so we don't want to re-enter this function.
+            return remainingInvocations();
+        }
+        m_isEvaluating = true;
+        Private::TraceScope trace("evaluator", "ConnectionEvaluator::evaluateDeferredConnections", this);
+
+        // The slots are evaluated without holding m_slotInvocationMutex, so emitting on other threads
+        // doesn't have to wait for them. Invocations that are queued in the meantime are stored in the
+        // lanes. At most as many invocations as were queued when the evaluation started are taken,
+        // so that threads that keep emitting can't keep the evaluation running forever.
+        std::size_t maxInvocations;
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_slotInvocationMutex);
+            maxInvocations = (std::min)(budget.maxInvocations, m_queueDepth);
+        }
+        // With a deadline, the invocations are taken in chunks, so that only a few of them
+        // have to be returned to their lanes once the deadline has passed.
+        const auto chunkSize = budget.deadline ? DeadlineChunkSize : maxInvocations;
+
+        std::size_t evaluatedInvocations = 0;
+        std::size_t takenInvocations = 0;
+        try {
+            while (takenInvocations < maxInvocations && budget.allows(evaluatedInvocations)) {
+                {
+                    std::lock_guard<std::recursive_mutex> lock(m_slotInvocationMutex);
+                    fillBatch((std::min)(chunkSize, maxInvocations - takenInvocations));
+                }
+                if (m_batch.empty()) {
+                    break;
+                }
+                takenInvocations += m_batch.size();
+                while (m_batchBegin < m_batch.size() && budget.allows(evaluatedInvocations)) {
+                    auto &queuedInvocation = m_batch[m_batchBegin++];
+                    if (isStillConnected(queuedInvocation)) {
+                        ++evaluatedInvocations;
+                        queuedInvocation.second();
+                    }
+                }
+                if (m_batchBegin < m_batch.size()) {
+                    // The budget ran out in the middle of the batch.
+                    break;
+                }
+            }
+        } catch (...) {
+            // Best-effort: Discard the rest of the batch, so that the ConnectionEvaluator at least doesn't
+            // execute the same erroneous slot multiple times.
+            m_batch.clear();
+            m_batchBegin = 0;
+            m_isEvaluating = false;
+            throw;
+        }
+
+        m_isEvaluating = false;
+
+        std::lock_guard<std::recursive_mutex> lock(m_slotInvocationMutex);
+        returnBatchInvocations();
+        metricsRecorder().recordEvaluation(evaluatedInvocations, m_queueDepth);
+        return m_queueDepth;
+    }
+
+    // The number of queued invocations, including the ones in the batch that is currently being evaluated.
+    // Must only be called by the evaluating thread.
+    std::size_t remainingInvocations()
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_slotInvocationMutex);
+        return m_queueDepth + (m_batch.size() - m_batchBegin);
+    }
+
+    // Replaces m_batch with up to `maxInvocations` queued invocations.
+    //
+    // Must be called with m_slotInvocationMutex locked.
+    void fillBatch(std::size_t maxInvocations)
+    {
+        m_batch.clear();
+        m_batchBegin = 0;
+        m_disconnectsBeforeBatch = m_disconnects.load(std::memory_order_relaxed);
+        takeQueuedInvocations(m_batch, maxInvocations);
+    }
+
+    // Moves the invocations that a limited evaluation didn't get to, i.e. the ones from m_batchBegin on,
+    // back to the front of their lanes and clears m_batch.
+    //
+    // Keeping them in m_batch instead would evaluate them before invocations of higher priority that
+    // are queued in the meantime. Besides, the invocation of a conflated connection becomes its stored
+    // invocation again, so that later emits replace its arguments instead of queueing another one.
+    //
+    // Must be called with m_slotInvocationMutex locked.
+    void returnBatchInvocations()
+    {
+        // Going backwards returns the invocations of every lane in their original order.
+        for (auto i = m_batch.size(); i-- > m_batchBegin;) {
+            auto &queuedInvocation = m_batch[i];
+            auto *state = m_connections.get(queuedInvocation.first);
+            if (!state) {
+                continue;
+            }
+            if (state->conflated) {
+                if (state->conflatedInvocationQueued) {
+                    // A later emit already queued the connection again, with newer arguments.
+                    continue;
+                }
+                state->conflatedInvocation = std::move(queuedInvocation.second);
+                state->conflatedInvocationQueued = true;
+                queuedInvocation.second = nullptr;
+            }
+
+            auto &lane = m_lanes[state->lane];
+            if (lane.first > 0) {
+                lane.invocations[--lane.first] = std::move(queuedInvocation);
+            } else {
+                lane.invocations.insert(lane.invocations.begin(), std::move(queuedInvocation));
+            }
+            ++state->queuedInvocations;
+            ++m_queueDepth;
+        }
+        m_batch.clear();
+        m_batchBegin = 0;
+    }
+
+    // Whether an invocation in m_batch must still be evaluated.
+    //
+    // The invocations in m_batch were already taken from their connections, which skips the
+    // invocations of connections that were disconnected before the batch was taken.
+    // A connection may however be disconnected while the batch is evaluated. As disconnecting is rare,
+    // this only needs to lock the mutex if a connection was disconnected since the batch was taken.
+    bool isStillConnected(const QueuedInvocation &queuedInvocation) noexcept
+    {
+        if (!queuedInvocation.second) {
+            return false;
+        }
+        return m_disconnects.load(std::memory_order_acquire) == m_disconnectsBeforeBatch
+                || isConnectionRegistered(queuedInvocation.first);
+    }
+
+    // Adds the invocation to the queue.
+    // Returns false if the invocation was not queued, e.g. because its connection was disconnected.
+    //
+    // Overridden by ConnectionEvaluators that store their invocations differently.
+    virtual bool enqueue(const Private::GenerationalIndex &connection, SlotInvocation &&invocation)
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_slotInvocationMutex);
+        auto *state = m_connections.get(connection);
+        if (!state) {
+            return false;
+        }
+        m_lanes[state->lane].invocations.emplace_back(connection, std::move(invocation));
+        ++state->queuedInvocations;
+        ++m_queueDepth;
+        metricsRecorder().recordEnqueue(m_queueDepth);
+        return true;
+    }
+
+    bool isConnectionRegistered(const Private::GenerationalIndex &connection) noexcept
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_slotInvocationMutex);
+        return m_connections.get(connection) != nullptr;
+    }
+
+    // Replaces the placeholder of a conflated connection with its stored invocation.
+    // Leaves the placeholder empty if the connection was disconnected in the meantime.
+    //
+    // Must be called with m_slotInvocationMutex locked.
+    void takeConflatedInvocation(QueuedInvocation &queuedInvocation) noexcept
+    {
+        if (auto *state = m_connections.get(queuedInvocation.first)) {
+            state->conflatedInvocationQueued = false;
+            queuedInvocation.second = std::move(state->conflatedInvocation);
+        }
+    }
+
+    void discardConflatedInvocation(const Private::GenerationalIndex &connection) noexcept
+    {
+        SlotInvocation discardedInvocation;
+        std::lock_guard<std::recursive_mutex> lock(m_slotInvocationMutex);
+        if (auto *state = m_connections.get(connection)) {
+            state->conflatedInvocationQueued = false;
+            discardedInvocation = std::move(state->conflatedInvocation);
+        }
+    }
+
 private:
     template<typename...>
     friend class Signal;
 
-    void enqueueSlotInvocation(const ConnectionHandle &handle, const std::function<void()> &slotInvocation)
+    // The queued invocations of a single DeferredConnectionPriority.
+    struct Lane {
+        Lane() = default;
+
+        explicit Lane(pmr::memory_resource *resource)
+            : invocations(resource)
+        {
+        }
+
+        bool isEmpty() const noexcept
+        {
+            return first == invocations.size();
+        }
+
+        std::size_t size() const noexcept
+        {
+            return invocations.size() - first;
+        }
+
+        // Removes the invocations before `first`.
+        // They're only erased once they make up half of the lane, so that repeatedly evaluating
+        // a part of a long lane doesn't move the rest of the lane every time.
+        void removeEvaluatedInvocations()
+        {
+            if (isEmpty()) {
+                invocations.clear();
+                first = 0;
+                passedOver = 0;
+            } else if (first > invocations.size() / 2) {
+                invocations.erase(invocations.begin(), invocations.begin() + first);
+                first = 0;
+            }
+        }
+
+        Private::Vector<QueuedInvocation> invocations;
+        // The invocations before this one were already evaluated by a limited evaluation.
+        std::size_t first = 0;
+        // How many invocations of higher lanes were evaluated while this lane was waiting.
+        std::size_t passedOver = 0;
+    };
+
+    static constexpr std::size_t LaneCount = 3;
+    static constexpr std::size_t NoLane = LaneCount;
+
+    // Returns the lane whose invocations are evaluated next, and how many of its invocations
+    // may be evaluated before the next lane has to be chosen.
+    // Returns NoLane if no invocations are queued.
+    std::size_t nextLane(std::size_t &runLength) noexcept
+    {
+        // A lane that was passed over too often gets one of its invocations evaluated first.
+        for (auto lane = LaneCount; lane-- > 1;) {
+            if (!m_lanes[lane].isEmpty() && m_lanes[lane].passedOver >= StarvationLimit) {
+                m_lanes[lane].passedOver = 0;
+                runLength = 1;
+                return lane;
+            }
+        }
+        for (std::size_t lane = 0; lane < LaneCount; ++lane) {
+            if (!m_lanes[lane].isEmpty()) {
+                // If only a single lane is used, all of its invocations are evaluated in one run.
+                runLength = (std::numeric_limits<std::size_t>::max)();
+                for (auto lowerLane = lane + 1; lowerLane < LaneCount; ++lowerLane) {
+                    if (!m_lanes[lowerLane].isEmpty()) {
+                        runLength = (std::min)(runLength, StarvationLimit - m_lanes[lowerLane].passedOver);
+                    }
+                }
+                return lane;
+            }
+        }
+        return NoLane;
+    }
+
+    // Records that `count` invocations of the given lane were taken to be evaluated.
+    // Invocations of disconnected connections are never evaluated, so they must not be counted.
+    void passOver(std::size_t lane, std::size_t count) noexcept
+    {
+        for (auto lowerLane = lane + 1; lowerLane < LaneCount; ++lowerLane) {
+            auto &queue = m_lanes[lowerLane];
+            queue.passedOver = queue.isEmpty() ? 0 : queue.passedOver + count;
+        }
+    }
+
+    // Moves up to `maxInvocations` queued invocations to the end of `batch`, in the order in which they must be evaluated,
+    // and takes them from the queued invocations of their connections.
+    // The invocations of disconnected connections are dropped, so they neither end up in `batch`
+    // nor count against maxInvocations.
+    //
+    // Must be called with m_slotInvocationMutex locked.
+    void takeQueuedInvocations(Private::Vector<QueuedInvocation> &batch, std::size_t maxInvocations)
     {
+        std::size_t runLength;
+        for (auto lane = nextLane(runLength); lane != NoLane && maxInvocations > 0; lane = nextLane(runLength)) {
+            auto &queue = m_lanes[lane];
+            const auto maxCount = (std::min)(runLength, maxInvocations);
+            std::size_t count = 0;
+            if (batch.empty() && queue.first == 0 && maxCount >= queue.invocations.size()) {
+                // Swap the whole lane, which is only a pointer swap.
+                // Reserving first means that both vectors keep enough capacity for the next batch.
+                batch.reserve(queue.invocations.capacity());
+                std::swap(batch, queue.invocations);
+                // The invocations of disconnected connections are removed from the batch,
+                // so that it only contains the invocations that were taken, like the other branch.
+                for (auto &queuedInvocation : batch) {
+                    if (takeQueuedInvocation(queuedInvocation)) {
+                        if (&batch[count] != &queuedInvocation) {
+                            batch[count] = std::move(queuedInvocation);
+                        }
+                        ++count;
+                    }
+                }
+                batch.erase(batch.begin() + count, batch.end());
+            } else {
+                for (; count < maxCount && !queue.isEmpty(); ++queue.first) {
+                    auto &queuedInvocation = queue.invocations[queue.first];
+                    if (takeQueuedInvocation(queuedInvocation)) {
+                        batch.push_back(std::move(queuedInvocation));
+                        ++count;
+                    }
+                }
+            }
+            passOver(lane, count);
+            queue.removeEvaluatedInvocations();
+            maxInvocations -= count;
+        }
+    }
+
+    // Every deferred connection is registered with the ConnectionEvaluator when it is connected.
+    // Its queued invocations refer to it by the returned index, so disconnecting it only needs to
+    // unregister the index, instead of searching the queue for its invocations.
+    Private::GenerationalIndex registerConnection(DeferredConnectionMode mode, DeferredConnectionPriority priority)
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_slotInvocationMutex);
+        ConnectionState state;
+        state.lane = static_cast<uint8_t>(priority);
+        state.conflated = mode == DeferredConnectionMode::Conflated;
+        return m_connections.insert(std::move(state));
+    }
+
+    template<typename Func>
+    void enqueueSlotInvocation(const Private::GenerationalIndex &connection, DeferredConnectionMode mode, Func &&slotInvocation)
+    {
+        auto *resource = m_lanes[0].invocations.get_allocator().resource();
+        SlotInvocation invocation(std::allocator_arg, resource, std::forward<Func>(slotInvocation));
+        const bool queued = mode == DeferredConnectionMode::Conflated
+                ? enqueueConflated(connection, std::move(invocation))
+                : enqueue(connection, std::move(invocation));
+        if (queued) {
+            onInvocationAdded();
+        }
+    }
+
+    // A conflated connection has at most one queued invocation, which is stored with its registration.
+    // The queue only contains an empty invocation as a placeholder, which is replaced by the stored invocation
+    // when it is evaluated. Later emits only replace the stored invocation, so they don't grow the queue.
+    //
+    // Returns false if no placeholder was queued.
+    bool enqueueConflated(const Private::GenerationalIndex &connection, SlotInvocation &&invocation)
+    {
+        // The replaced invocation is destroyed once the mutex is unlocked.
+        SlotInvocation replacedInvocation;
         {
             std::lock_guard<std::recursive_mutex> lock(m_slotInvocationMutex);
-            m_deferredSlotInvocations.push_back({ handle, std::move(slotInvocation) });
+            auto *state = m_connections.get(connection);
+            if (!state) {
+                return false;
+            }
+            replacedInvocation = std::move(state->conflatedInvocation);
+            state->conflatedInvocation = std::move(invocation);
+            if (state->conflatedInvocationQueued) {
+                return false;
+            }
+            state->conflatedInvocationQueued = true;
         }
-        onInvocationAdded();
+
+        if (!enqueue(connection, SlotInvocation())) {
+            // The placeholder was discarded, so the next emit needs to queue a new one.
+            discardConflatedInvocation(connection);
+            return false;
+        }
+        return true;
     }
 
+    // Unregisters the connection, so that none of its queued invocations are evaluated anymore.
+    // The invocations stay in the queue until the next evaluation, which skips them, as their
+    // connection is no longer registered. That way this function doesn't depend on the size of the queue.
+    //
+    // If the invocations are currently being evaluated, the invocation that is currently running
+    // is not affected, but any later invocations of the connection are skipped.
+    //
     // Note: This function is marked with noexcept but may theoretically encounter an exception and terminate the program if locking the mutex fails.
     // If this does happen though, there's likely something very wrong, so std::terminate is actually a reasonable way to handle this.
     //
-    // In addition, we do need to use a recursive_mutex, as otherwise a slot from `enqueueSlotInvocation` may theoretically call this function and cause undefined behavior.
-    void dequeueSlotInvocation(const ConnectionHandle &handle) noexcept
+    // In addition, we do need to use a recursive_mutex, as otherwise a slot from `evaluateDeferredConnections` may theoretically call this function and cause undefined behavior.
+    void dequeueSlotInvocation(const Private::GenerationalIndex &connection) noexcept
     {
         std::lock_guard<std::recursive_mutex> lock(m_slotInvocationMutex);
 
-        if (m_isEvaluating) {
-            // It's too late, we're already evaluating the deferred connections.
-            // We can't remove the invocation now, as it might be currently evaluated.
-            // And removing any invocations would be undefined behavior as we would invalidate
-            // the loop indices in `evaluateDeferredConnections`.
-            return;
+        if (auto *state = m_connections.get(connection)) {
+            const auto dequeuedInvocations = state->queuedInvocations;
+            // Note: This function may throw if we're out of memory.
+            // As `dequeueSlotInvocation` is marked as `noexcept`, this will terminate the program.
+            m_connections.erase(connection);
+            m_disconnects.fetch_add(1, std::memory_order_release);
+            if (dequeuedInvocations > 0) {
+                m_queueDepth -= dequeuedInvocations;
+                metricsRecorder().recordDequeue(m_queueDepth);
+            }
         }
+    }
 
-        auto handleMatches = [&handle](const auto &invocationPair) {
-            return invocationPair.first == handle;
-        };
-
-        // Remove all invocations that match the handle
-        m_deferredSlotInvocations.erase(
-                std::remove_if(m_deferredSlotInvocations.begin(), m_deferredSlotInvocations.end(), handleMatches),
-                m_deferredSlotInvocations.end());
+    // Removes a queued invocation from the count of its connection.
+    // Returns false if the invocation must not be evaluated, because its connection was disconnected
+    // after the invocation was queued.
+    //
+    // Must be called with m_slotInvocationMutex locked.
+    bool takeQueuedInvocation(QueuedInvocation &queuedInvocation) noexcept
+    {
+        auto *state = m_connections.get(queuedInvocation.first);
+        if (!state) {
+            return false;
+        }
+        if (!queuedInvocation.second) {
+            takeConflatedInvocation(queuedInvocation);
+        }
+        --state->queuedInvocations;
+        --m_queueDepth;
+        return static_cast<bool>(queuedInvocation.second);
     }
 
-    std::vector<std::pair<ConnectionHandle, std::function<void()>>> m_deferredSlotInvocations;
-    // We need to use a recursive mutex here, as `evaluateDeferredConnections` executes arbitrary user code.
-    // This may end up in a call to dequeueSlotInvocation, which locks the same mutex.
-    // We'll also need to add a flag to make sure we don't actually dequeue invocations while we're evaluating them.
+    struct ConnectionState {
+        // The number of invocations of the connection in its lane.
+        uint32_t queuedInvocations = 0;
+        // The lane of the connection's DeferredConnectionPriority.
+        uint8_t lane = static_cast<uint8_t>(DeferredConnectionPriority::Normal);
+        // Whether the connection uses DeferredConnectionMode::Conflated.
+        bool conflated = false;
+        // Conflated connections only: Whether a placeholder for conflatedInvocation is queued.
+        bool conflatedInvocationQueued = false;
+        SlotInvocation conflatedInvocation;
+    };
+
+    // One lane per DeferredConnectionPriority, in order of priority.
+    std::array<Lane, LaneCount> m_lanes;
+    static_assert(static_cast<std::size_t>(DeferredConnectionPriority::Low) + 1 == LaneCount);
+
+protected:
+    // The registered deferred connections.
+    Private::GenerationalIndexArray<ConnectionState> m_connections;
+    // The number of invocations in the lanes whose connection is still registered.
+    std::size_t m_queueDepth = 0;
+    // Guards the lanes and the registered connections, but is never held while slots are evaluated.
+    // We need to use a recursive mutex here, as destroying an invocation may destroy arbitrary user code,
+    // which may end up in a call to dequeueSlotInvocation, which locks the same mutex.
     std::recursive_mutex m_slotInvocationMutex;
+
+    // The invocations that were taken from the lanes to be evaluated, starting at m_batchBegin.
+    // The invocations before m_batchBegin were already evaluated.
+    // Only used by the evaluating thread.
+    Private::Vector<QueuedInvocation> m_batch;
+    std::size_t m_batchBegin = 0;
+    // The number of connections that were unregistered so far, and before the oldest invocation in m_batch was taken.
+    std::atomic<std::size_t> m_disconnects{ 0 };
+    std::size_t m_disconnectsBeforeBatch = 0;
+    // Only one thread evaluates at a time. This needs to be a recursive mutex, as a slot may
+    // evaluate the deferred connections again, which we detect with m_isEvaluating.
+    std::recursive_mutex m_evaluationMutex;
     bool m_isEvaluating = false;
+
+    // Without KDBINDINGS_ENABLE_METRICS, the recorder has no state, so ConnectionEvaluators
+    // share a single one instead of each carrying an empty member.
+    Private::ConnectionEvaluatorMetricsRecorder &metricsRecorder() noexcept
+    {
+#ifdef KDBINDINGS_ENABLE_METRICS
+        return m_metrics;
+#else
+        static Private::ConnectionEvaluatorMetricsRecorder recorder;
+        return recorder;
+#endif
+    }
+
+private:
+#ifdef KDBINDINGS_ENABLE_METRICS
+    Private::ConnectionEvaluatorMetricsRecorder m_metrics;
+#endif
 };
 } // namespace KDBindings
@@ -12,6 +12,7 @@
 #pragma once
 
 #include <kdbindings/genindex_array.h>
+#include <kdbindings/shared_ptr.h>
 #include <kdbindings/utils.h>
 #include <memory>
 
@@ -20,6 +21,9 @@ namespace KDBindings {
 template<typename... Args>
 class Signal;
 
+template<typename... Args>
+class ThreadSafeSignal;
+
 class ConnectionHandle;
 
 namespace Private {
@@ -29,7 +33,7 @@ namespace Private {
 // It allows ConnectionHandle to refer to this non-template class, which then dispatches
 // to the template implementation using virtual function calls.
 // It allows ConnectionHandle to be a non-template class.
-class SignalImplBase : public std::enable_shared_from_this<SignalImplBase>
+class SignalImplBase : public EnableSharedFromThis<SignalImplBase>
 {
 public:
     SignalImplBase() = default;
@@ -64,14 +68,38 @@ public:
     /**
      * A ConnectionHandle can be copied.
      **/
-    ConnectionHandle(const ConnectionHandle &) noexcept = default;
-    ConnectionHandle &operator=(const ConnectionHandle &) noexcept = default;
+    ConnectionHandle(const ConnectionHandle &other) noexcept
+        : m_signalImpl{ other.owningSignalImpl() }, m_id{ other.m_id }
+    {
+    }
+
+    ConnectionHandle &operator=(const ConnectionHandle &other) noexcept
+    {
+        if (this != &other) {
+            m_signalImpl = other.owningSignalImpl();
+            m_borrowedSignalImpl = nullptr;
+            m_id = other.m_id;
+        }
+        return *this;
+    }
 
     /**
      * A ConnectionHandle can be moved.
      **/
-    ConnectionHandle(ConnectionHandle &&) noexcept = default;
-    ConnectionHandle &operator=(ConnectionHandle &&) noexcept = default;
+    ConnectionHandle(ConnectionHandle &&other) noexcept
+        : m_signalImpl{ other.m_borrowedSignalImpl ? other.owningSignalImpl() : std::move(other.m_signalImpl) }, m_id{ other.m_id }
+    {
+    }
+
+    ConnectionHandle &operator=(ConnectionHandle &&other) noexcept
+    {
+        if (this != &other) {
+            m_signalImpl = other.m_borrowedSignalImpl ? other.owningSignalImpl() : std::move(other.m_signalImpl);
+            m_borrowedSignalImpl = nullptr;
+            m_id = other.m_id;
+        }
+        return *this;
+    }
 
     /**
      * Disconnect the slot.
@@ -96,11 +124,16 @@ public:
 
         // ConnectionHandle is no longer active;
         m_signalImpl.reset();
+        m_borrowedSignalImpl = nullptr;
     }
 
     /**
      * Check whether the connection of this ConnectionHandle is active.
      *
+     * A connection that is disconnected while its Signal is emitting is inactive right away,
+     * even though its slot is only destroyed once the emit is done.
+     * This applies to all ConnectionHandles of the connection, not only the one it was disconnected with.
+     *
      * @return true if the ConnectionHandle refers to an active Signal
      * and the connection was not disconnected previously, false otherwise.
      **/
@@ -156,19 +189,31 @@ public:
     template<typename... Args>
     bool belongsTo(const Signal<Args...> &signal) const
     {
-        auto shared_impl = m_signalImpl.lock();
-        return shared_impl && shared_impl == std::static_pointer_cast<Private::SignalImplBase>(signal.m_impl);
+        auto shared_impl = lock();
+        return shared_impl && shared_impl.get() == static_cast<Private::SignalImplBase *>(signal.m_impl.get());
+    }
+
+    /**
+     * Check whether this ConnectionHandle belongs to the given ThreadSafeSignal.
+     *
+     * @return true if this ConnectionHandle refers to a connection within the given ThreadSafeSignal
+     **/
+    template<typename... Args>
+    bool belongsTo(const ThreadSafeSignal<Args...> &signal) const
+    {
+        auto shared_impl = lock();
+        return shared_impl && shared_impl.get() == static_cast<Private::SignalImplBase *>(signal.m_impl.get());
     }
 
     // Define an operator== function to compare ConnectionHandle objects.
     bool operator==(const ConnectionHandle &other) const
     {
-        auto thisSignalImpl = m_signalImpl.lock();
-        auto otherSignalImpl = other.m_signalImpl.lock();
+        auto thisSignalImpl = lock();
+        auto otherSignalImpl = other.lock();
 
         // If both signalImpl pointers are valid, compare them along with the IDs.
         if (thisSignalImpl && otherSignalImpl) {
-            return (thisSignalImpl == otherSignalImpl) && (m_id == other.m_id);
+            return (thisSignalImpl.get() == otherSignalImpl.get()) && (m_id == other.m_id);
         }
 
         // If neither instance has an ID, and both signalImpl pointers are invalid, consider them equal.
@@ -200,31 +245,98 @@ public:
 private:
     template<typename...>
     friend class Signal;
+    template<typename...>
+    friend class ThreadSafeSignal;
 
-    std::weak_ptr<Private::SignalImplBase> m_signalImpl;
+    Private::WeakPtr<Private::SignalImplBase> m_signalImpl;
+    // A borrowed ConnectionHandle refers to its Signal without owning a weak_ptr to it.
+    // See ConnectionHandle::borrowed.
+    Private::SignalImplBase *m_borrowedSignalImpl = nullptr;
     std::optional<Private::GenerationalIndex> m_id;
 
-    // private, so it is only available from Signal
-    ConnectionHandle(std::weak_ptr<Private::SignalImplBase> signalImpl, std::optional<Private::GenerationalIndex> id)
+    // private, so it is only available from Signal and ThreadSafeSignal
+    ConnectionHandle(Private::WeakPtr<Private::SignalImplBase> signalImpl, std::optional<Private::GenerationalIndex> id)
         : m_signalImpl{ std::move(signalImpl) }, m_id{ std::move(id) }
     {
     }
+
+    // Creates a ConnectionHandle that refers to the Signal with a raw pointer, which avoids the
+    // reference counting of the weak pointer.
+    // This is used to pass a ConnectionHandle to reflective slots, as the Signal is guaranteed to be alive
+    // while the slot is called.
+    // Such a handle must not outlive the call. Copying or moving it creates a normal ConnectionHandle,
+    // so only slots that keep their handle pay for the weak_ptr.
+    static ConnectionHandle borrowed(Private::SignalImplBase *signalImpl, const Private::GenerationalIndex &id) noexcept
+    {
+        return ConnectionHandle(BorrowedTag{}, signalImpl, id);
+    }
+
+    struct BorrowedTag {
+    };
+
+    ConnectionHandle(BorrowedTag, Private::SignalImplBase *signalImpl, const Private::GenerationalIndex &id) noexcept
+        : m_borrowedSignalImpl{ signalImpl }, m_id{ id }
+    {
+    }
+
     void setId(const Private::GenerationalIndex &id)
     {
         m_id = id;
     }
 
+    Private::WeakPtr<Private::SignalImplBase> owningSignalImpl() const noexcept
+    {
+        if (m_borrowedSignalImpl) {
+            return m_borrowedSignalImpl->weak_from_this();
+        }
+        return m_signalImpl;
+    }
+
+    // Keeps the Signal alive while a ConnectionHandle uses it.
+    // For borrowed handles, this is just the raw pointer.
+    class LockedSignalImpl
+    {
+    public:
+        LockedSignalImpl() noexcept = default;
+
+        explicit LockedSignalImpl(Private::SignalImplBase *borrowed) noexcept
+            : m_impl(borrowed)
+        {
+        }
+
+        explicit LockedSignalImpl(Private::SharedPtr<Private::SignalImplBase> owned) noexcept
+            : m_owner(std::move(owned)), m_impl(m_owner.get())
+        {
+        }
+
+        Private::SignalImplBase *get() const noexcept { return m_impl; }
+        Private::SignalImplBase *operator->() const noexcept { return m_impl; }
+        explicit operator bool() const noexcept { return m_impl != nullptr; }
+
+    private:
+        Private::SharedPtr<Private::SignalImplBase> m_owner;
+        Private::SignalImplBase *m_impl = nullptr;
+    };
+
+    LockedSignalImpl lock() const noexcept
+    {
+        if (m_borrowedSignalImpl) {
+            return LockedSignalImpl(m_borrowedSignalImpl);
+        }
+        return LockedSignalImpl(m_signalImpl.lock());
+    }
+
     // Checks that the weak_ptr can be locked and that the connection is
     // still active
-    std::shared_ptr<Private::SignalImplBase> checkedLock() const noexcept
+    LockedSignalImpl checkedLock() const noexcept
     {
         if (m_id.has_value()) {
-            auto shared_impl = m_signalImpl.lock();
+            auto shared_impl = lock();
             if (shared_impl && shared_impl->isConnectionActive(*m_id)) {
                 return shared_impl;
             }
         }
-        return nullptr;
+        return {};
     }
 };
 
@@ -0,0 +1,210 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <system_error>
+
+#include <kdbindings/connection_evaluator.h>
+
+#ifndef __linux__
+#error "EventFdConnectionEvaluator is only available on Linux"
+#endif
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace KDBindings {
+
+/**
+ * @brief A ConnectionEvaluator that can be integrated into poll or epoll based event loops.
+ *
+ * @warning Deferred connections are experimental and may be removed or changed in the future.
+ *
+ * The EventFdConnectionEvaluator owns an eventfd, which becomes readable when a slot invocation is
+ * queued while no other invocations are queued.
+ * Only this transition writes to the eventfd, so emitting many times between two evaluations
+ * causes at most one wakeup of the event loop.
+ * Every evaluation of the deferred connections first resets the eventfd, whether or not an invocation
+ * was queued since the last evaluation. It only becomes readable again if a limited evaluation
+ * (see evaluateDeferredConnections(std::size_t) and evaluateFor()) leaves invocations queued,
+ * or once the next invocation is queued.
+ *
+ * An emit on another thread may queue its invocation before the evaluation takes the queued invocations,
+ * but only write to the eventfd after it was reset. Its invocation is then evaluated right away,
+ * and the eventfd is left readable. This causes one more evaluation, which finds nothing to evaluate,
+ * but resets the eventfd, so it never stays readable while nothing is queued.
+ *
+ * Example:
+ * @code
+ * auto evaluator = std::make_shared<EventFdConnectionEvaluator>();
+ *
+ * epoll_event event{};
+ * event.events = EPOLLIN;
+ * event.data.ptr = evaluator.get();
+ * epoll_ctl(epollFd, EPOLL_CTL_ADD, evaluator->fileDescriptor(), &event);
+ *
+ * // In the event loop, once the file descriptor is readable:
+ * evaluator->evaluateDeferredConnections();
+ * @endcode
+ *
+ * Threads that only evaluate the deferred connections can use waitAndEvaluate() instead.
+ *
+ * EventFdConnectionEvaluator is only available on Linux.
+ *
+ * @see Signal::connectDeferred()
+ */
+class EventFdConnectionEvaluator : public ConnectionEvaluator
+{
+public:
+    /**
+     * Constructs an EventFdConnectionEvaluator that allocates the queued slot invocations
+     * from the given memory resource, which must outlive the EventFdConnectionEvaluator.
+     *
+     * @throw std::system_error - If the eventfd can't be created.
+     */
+    explicit EventFdConnectionEvaluator(pmr::memory_resource *resource = pmr::new_delete_resource())
+        : ConnectionEvaluator(resource)
+        , m_eventFd(::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
+    {
+        if (m_eventFd < 0) {
+            throw std::system_error(errno, std::generic_category(), "Failed to create the eventfd of EventFdConnectionEvaluator");
+        }
+    }
+
+    ~EventFdConnectionEvaluator() override
+    {
+        ::close(m_eventFd);
+    }
+
+    /**
+     * The eventfd that becomes readable when slot invocations are queued.
+     *
+     * Wait for it with poll, select or epoll, but don't read from it, that's done by evaluating the deferred connections.
+     * The file descriptor is owned by the EventFdConnectionEvaluator and closed by its destructor.
+     */
+    int fileDescriptor() const noexcept
+    {
+        return m_eventFd;
+    }
+
+    /**
+     * @brief Waits until slot invocations are queued, and evaluates them.
+     *
+     * Blocks the calling thread until the eventfd becomes readable or the timeout has passed.
+     * If invocations are queued in time, the deferred connections are evaluated
+     * like with evaluateDeferredConnections().
+     *
+     * Example:
+     * @code
+     * while (running) {
+     *     evaluator->waitAndEvaluate(std::chrono::milliseconds(100));
+     * }
+     * @endcode
+     *
+     * @return true if the deferred connections were evaluated, false if the timeout passed first.
+     */
+    template<typename Rep, typename Period>
+    bool waitAndEvaluate(std::chrono::duration<Rep, Period> timeout)
+    {
+        if (!waitFor(std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout))) {
+            return false;
+        }
+        evaluateDeferredConnections();
+        return true;
+    }
+
+protected:
+    /**
+     * Writes to the eventfd if no other invocations were queued since the last evaluation.
+     *
+     * Subclasses that override this function must call this implementation,
+     * otherwise the eventfd never becomes readable.
+     */
+    void onInvocationAdded() override
+    {
+        // Only the first invocation after an evaluation needs to wake up the event loop.
+        if (!m_notified.exchange(true, std::memory_order_acq_rel)) {
+            writeEventFd();
+        }
+    }
+
+private:
+    std::size_t evaluateQueuedInvocations(const EvaluationBudget &budget) override
+    {
+        // Reset the eventfd before the invocations are taken, so an invocation that is queued
+        // after they were taken is guaranteed to write to it again.
+        // The eventfd must be drained even if m_notified is not set: a write of onInvocationAdded
+        // may have landed after the previous evaluation drained it, and would otherwise keep
+        // the eventfd readable forever.
+        // Only clear m_notified once the eventfd is drained, so that a write racing with this
+        // evaluation is never lost.
+        readEventFd();
+        m_notified.store(false, std::memory_order_release);
+
+        const auto remainingInvocations = ConnectionEvaluator::evaluateQueuedInvocations(budget);
+        if (remainingInvocations > 0) {
+            // A limited evaluation left invocations queued, so the event loop needs to come back for them.
+            onInvocationAdded();
+        }
+        return remainingInvocations;
+    }
+
+    // Returns true if the eventfd became readable before the timeout passed.
+    bool waitFor(std::chrono::steady_clock::duration timeout)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        pollfd pollFd{};
+        pollFd.fd = m_eventFd;
+        pollFd.events = POLLIN;
+        for (;;) {
+            // poll only takes milliseconds, round up so that short timeouts don't turn into busy waiting.
+            const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+            const auto timeoutMs = remaining <= 0 ? 0 : static_cast<int>((std::min<decltype(remaining)>)(remaining, (std::numeric_limits<int>::max)()));
+            const auto result = ::poll(&pollFd, 1, timeoutMs);
+            if (result >= 0) {
+                return result > 0;
+            }
+            if (errno != EINTR) {
+                throw std::system_error(errno, std::generic_category(), "Failed to wait for the eventfd of EventFdConnectionEvaluator");
+            }
+        }
+    }
+
+    void writeEventFd() noexcept
+    {
+        const uint64_t value = 1;
+        // The only possible error is EINTR, as the counter can't overflow with a single write per evaluation.
+        while (::write(m_eventFd, &value, sizeof(value)) < 0 && errno == EINTR) {
+        }
+    }
+
+    void readEventFd() noexcept
+    {
+        uint64_t value;
+        // The eventfd is non-blocking, so EAGAIN simply means that it was already reset.
+        while (::read(m_eventFd, &value, sizeof(value)) < 0 && errno == EINTR) {
+        }
+    }
+
+    int m_eventFd;
+    // Whether an invocation was queued since the eventfd was last reset.
+    std::atomic<bool> m_notified{ false };
+};
+
+} // namespace KDBindings
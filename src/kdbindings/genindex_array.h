@@ -20,6 +20,8 @@ IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
+#include <kdbindings/memory_resource.h>
+
 #include <functional>
 #include <vector>
 #include <cstdint>
@@ -50,10 +52,17 @@ class GenerationalIndexAllocator
         uint32_t generation = 0;
     };
 
-    std::vector<AllocatorEntry> m_entries;
-    std::vector<uint32_t> m_freeIndices;
+    Vector<AllocatorEntry> m_entries;
+    Vector<uint32_t> m_freeIndices;
 
 public:
+    GenerationalIndexAllocator() = default;
+
+    explicit GenerationalIndexAllocator(pmr::memory_resource *resource) noexcept
+        : m_entries(resource), m_freeIndices(resource)
+    {
+    }
+
     GenerationalIndex allocate()
     {
         if (m_freeIndices.size() > 0) {
@@ -110,10 +119,18 @@ class GenerationalIndexArray
     // TODO: m_entries never shrinks after an entry has been deleted, it might be
     // a good idea to add a "trim" function at some point if this becomes an issue
 
-    std::vector<std::optional<Entry>> m_entries;
+    Vector<std::optional<Entry>> m_entries;
     GenerationalIndexAllocator m_allocator;
 
 public:
+    GenerationalIndexArray() = default;
+
+    // All memory of the array is allocated from the given memory resource.
+    explicit GenerationalIndexArray(pmr::memory_resource *resource) noexcept
+        : m_entries(resource), m_allocator(resource)
+    {
+    }
+
     // Sets the value at a specific index inside the array
     void set(const GenerationalIndex index, T &&value)
     {
@@ -141,10 +158,19 @@ public:
         return index;
     }
 
+    // Allocate an index without storing a value at it yet.
+    // get() returns nullptr for the index until a value is stored with set().
+    // This never reallocates the storage of the existing values.
+    GenerationalIndex allocateIndex()
+    {
+        return m_allocator.allocate();
+    }
+
     // Erase the value at the specified index and free up the index again
     void erase(GenerationalIndex index)
     {
-        if (m_allocator.deallocate(index))
+        // An index returned by allocateIndex may not have any storage yet.
+        if (m_allocator.deallocate(index) && index.index < m_entries.size())
             m_entries[index.index] = std::nullopt;
     }
 
@@ -208,6 +234,197 @@ public:
     }
 };
 
+// A DenseGenerationalIndexArray provides the same generational indices as a GenerationalIndexArray,
+// but keeps its values densely packed in a std::vector (also known as a "slot map").
+//
+// Every index refers to a slot, which in turn stores the position of its value.
+// Erasing a value moves the values behind it forward, so the values never contain any holes.
+// Iterating over all values with size()/valueAt() therefore only visits live values,
+// no matter how many values have been erased before.
+// The values stay in the order in which they were stored.
+//
+// In exchange, erasing a value has to move all values that were stored after it.
+template<typename T>
+class DenseGenerationalIndexArray
+{
+    static constexpr uint32_t NoValue = (std::numeric_limits<uint32_t>::max)();
+
+    struct Slot {
+        uint32_t generation = 0;
+        uint32_t position = NoValue;
+        bool isLive = false;
+    };
+
+    Vector<T> m_values;
+    // The index of the slot that refers to each value
+    Vector<uint32_t> m_slotOfValue;
+    Vector<Slot> m_slots;
+    Vector<uint32_t> m_freeSlots;
+
+public:
+    DenseGenerationalIndexArray() = default;
+
+    // All memory of the array is allocated from the given memory resource.
+    explicit DenseGenerationalIndexArray(pmr::memory_resource *resource) noexcept
+        : m_values(resource), m_slotOfValue(resource), m_slots(resource), m_freeSlots(resource)
+    {
+    }
+
+    // Allocate an index without storing a value at it yet.
+    // get() returns nullptr for the index until a value is stored with set().
+    // This never reallocates the storage of the existing values.
+    GenerationalIndex allocateIndex()
+    {
+        if (!m_freeSlots.empty()) {
+            const uint32_t index = m_freeSlots.back();
+            m_freeSlots.pop_back();
+
+            auto &slot = m_slots[index];
+            slot.generation += 1;
+            slot.isLive = true;
+            return { index, slot.generation };
+        }
+
+        // check that we are still within the bounds of uint32_t
+        // (parentheses added to avoid Windows min/max macros)
+        if (m_slots.size() + 1 >= (std::numeric_limits<uint32_t>::max)()) {
+            throw std::length_error(std::string("Maximum number of values inside DenseGenerationalIndexArray reached: ") + std::to_string(m_slots.size()));
+        }
+
+        m_slots.push_back({ 0, NoValue, true });
+        return { static_cast<uint32_t>(m_slots.size()) - 1, 0 };
+    }
+
+    // Stores the value at an index that was returned by allocateIndex and doesn't have a value yet.
+    void set(const GenerationalIndex index, T &&value)
+    {
+        assert(isLive(index) && m_slots[index.index].position == NoValue);
+
+        m_slotOfValue.push_back(index.index);
+        try {
+            m_values.push_back(std::move(value));
+        } catch (...) {
+            m_slotOfValue.pop_back();
+            throw;
+        }
+        m_slots[index.index].position = static_cast<uint32_t>(m_values.size()) - 1;
+    }
+
+    // Insert a value and get its index back
+    GenerationalIndex insert(T &&value)
+    {
+        const auto index = allocateIndex();
+        try {
+            set(index, std::move(value));
+        } catch (...) {
+            erase(index);
+            throw;
+        }
+        return index;
+    }
+
+    // Erase the value at the specified index and free up the index again.
+    // The values after the erased value move forward by one position, keeping their order.
+    void erase(GenerationalIndex index)
+    {
+        if (!isLive(index))
+            return;
+
+        auto &slot = m_slots[index.index];
+        const auto position = slot.position;
+        slot.position = NoValue;
+        slot.isLive = false;
+        m_freeSlots.push_back(index.index);
+
+        if (position == NoValue)
+            return;
+
+        // Only destroy the erased value once the array is consistent again,
+        // in case its destructor accesses the array.
+        [[maybe_unused]] T erased = std::move(m_values[position]);
+
+        const auto size = static_cast<uint32_t>(m_values.size());
+        for (auto next = position + 1; next < size; ++next) {
+            m_values[next - 1] = std::move(m_values[next]);
+            m_slotOfValue[next - 1] = m_slotOfValue[next];
+            m_slots[m_slotOfValue[next - 1]].position = next - 1;
+        }
+        m_values.pop_back();
+        m_slotOfValue.pop_back();
+    }
+
+    // Get a pointer to the value at the specified index
+    T *get(GenerationalIndex index) noexcept
+    {
+        if (!isLive(index))
+            return nullptr;
+
+        const auto position = m_slots[index.index].position;
+        return position == NoValue ? nullptr : &m_values[position];
+    }
+
+    // Get a const pointer to the value at the specified index
+    const T *get(GenerationalIndex index) const noexcept
+    {
+        return const_cast<DenseGenerationalIndexArray *>(this)->get(index);
+    }
+
+    // Erase all the values in the array and thus free up their indices too.
+    // Indices that were allocated with allocateIndex but don't have a value yet stay allocated.
+    void clear()
+    {
+        m_freeSlots.reserve(m_freeSlots.size() + m_slotOfValue.size());
+        for (const auto slotIndex : m_slotOfValue) {
+            auto &slot = m_slots[slotIndex];
+            slot.position = NoValue;
+            slot.isLive = false;
+            m_freeSlots.push_back(slotIndex);
+        }
+        m_slotOfValue.clear();
+
+        // Only destroy the values once the array is consistent again, in case their destructors
+        // access the array. The storage is reused afterwards, unless a destructor added new values.
+        auto values = std::move(m_values);
+        values.clear();
+        if (m_values.empty()) {
+            m_values = std::move(values);
+        }
+    }
+
+    // The number of values in the array
+    uint32_t size() const noexcept
+    {
+        // this cast is safe because allocateIndex checks that we never exceed the capacity of uint32_t
+        return static_cast<uint32_t>(m_values.size());
+    }
+
+    // Access the value at a position between 0 and size()
+    T &valueAt(uint32_t position) noexcept
+    {
+        return m_values[position];
+    }
+
+    const T &valueAt(uint32_t position) const noexcept
+    {
+        return m_values[position];
+    }
+
+    // The index of the value at a position between 0 and size()
+    GenerationalIndex indexAt(uint32_t position) const noexcept
+    {
+        const auto slotIndex = m_slotOfValue[position];
+        return { slotIndex, m_slots[slotIndex].generation };
+    }
+
+private:
+    bool isLive(GenerationalIndex index) const noexcept
+    {
+        return index.index < m_slots.size() &&
+                m_slots[index.index].generation == index.generation &&
+                m_slots[index.index].isLive;
+    }
+};
+
 } // namespace Private
 
 } // namespace KDBindings
@@ -0,0 +1,437 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include <kdbindings/connection_evaluator.h>
+#include <kdbindings/genindex_array.h>
+#include <kdbindings/memory_resource.h>
+#include <kdbindings/tracing.h>
+#include <kdbindings/utils.h>
+
+#include <kdbindings/KDBindingsConfig.h>
+
+#ifdef KDBINDINGS_SINGLE_THREADED
+#error "LockFreeConnectionEvaluator is not available when KDBindings is built with KDBINDINGS_SINGLE_THREADED"
+#endif
+
+namespace KDBindings {
+
+/**
+ * @brief What a LockFreeConnectionEvaluator does with a slot invocation when its queue is full.
+ */
+enum class OverflowPolicy {
+    /**
+     * The emitting thread waits until the evaluating thread has made room in the queue.
+     *
+     * If the queue is full while a slot that is evaluated by the ConnectionEvaluator emits
+     * another deferred invocation, waiting would never end. Such invocations are therefore
+     * stored like with OverflowPolicy::Grow.
+     */
+    Block,
+    /** The new invocation is discarded. */
+    DropNewest,
+    /** The oldest queued invocation is discarded to make room for the new one. */
+    DropOldest,
+    /**
+     * The invocation is stored in an overflow list, which is allocated as needed.
+     * Invocations are still evaluated in the order in which they were queued.
+     */
+    Grow,
+};
+
+namespace Private {
+
+// A bounded multi-producer queue, backed by a ring buffer that is allocated once.
+//
+// This is the bounded MPMC queue by Dmitry Vyukov: every cell has a sequence number that tells
+// producers and consumers whether the cell is free for the current lap around the ring.
+// Claiming a cell is a single compare-and-swap on the enqueue or dequeue position,
+// which live on separate cache lines, just like the cells themselves,
+// so producers and the consumer don't invalidate each other's cache lines.
+//
+// A LockFreeConnectionEvaluator only has a single consumer, but producers may also pop from the
+// queue to drop the oldest element, so popping is safe from multiple threads as well.
+template<typename T>
+class BoundedQueue
+{
+public:
+    BoundedQueue(std::size_t capacity, pmr::memory_resource *resource)
+        : m_cells(roundUpToPowerOfTwo(capacity), ResourceAllocator<Cell>(resource))
+        , m_mask(m_cells.size() - 1)
+    {
+        for (std::size_t i = 0; i < m_cells.size(); ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    // Moves the value into the queue, unless the queue is full.
+    bool tryPush(T &value) noexcept
+    {
+        auto position = m_enqueuePosition.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;) {
+            cell = &m_cells[position & m_mask];
+            const auto sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (difference == 0) {
+                if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                // The consumer hasn't freed this cell in the previous lap yet.
+                return false;
+            } else {
+                position = m_enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Moves the oldest value out of the queue, unless the queue is empty.
+    bool tryPop(T &value) noexcept
+    {
+        auto position = m_dequeuePosition.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;) {
+            cell = &m_cells[position & m_mask];
+            const auto sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+            if (difference == 0) {
+                if (m_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                // No producer has filled this cell yet.
+                return false;
+            } else {
+                position = m_dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(cell->value);
+        cell->sequence.store(position + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // The number of values in the queue, including values that are still being pushed.
+    // This is only a snapshot, as other threads may push and pop at the same time.
+    std::size_t size() const noexcept
+    {
+        const auto dequeuePosition = m_dequeuePosition.load(std::memory_order_acquire);
+        const auto enqueuePosition = m_enqueuePosition.load(std::memory_order_acquire);
+        return enqueuePosition > dequeuePosition ? enqueuePosition - dequeuePosition : 0;
+    }
+
+    std::size_t capacity() const noexcept
+    {
+        return m_cells.size();
+    }
+
+private:
+    struct alignas(CacheLineSize) Cell {
+        std::atomic<std::size_t> sequence{ 0 };
+        T value{};
+    };
+
+    static std::size_t roundUpToPowerOfTwo(std::size_t capacity) noexcept
+    {
+        std::size_t result = 2;
+        while (result < capacity) {
+            result *= 2;
+        }
+        return result;
+    }
+
+    Vector<Cell> m_cells;
+    const std::size_t m_mask;
+    alignas(CacheLineSize) std::atomic<std::size_t> m_enqueuePosition{ 0 };
+    alignas(CacheLineSize) std::atomic<std::size_t> m_dequeuePosition{ 0 };
+};
+
+} // namespace Private
+
+/**
+ * @brief A ConnectionEvaluator that queues slot invocations without taking a lock.
+ *
+ * @warning Deferred connections are experimental and may be removed or changed in the future.
+ *
+ * The queued slot invocations are stored in a ring buffer of a fixed capacity, which is allocated
+ * when the LockFreeConnectionEvaluator is constructed.
+ * Emitting a Signal with a deferred connection to a LockFreeConnectionEvaluator only needs to claim
+ * a free cell in the ring buffer, so it never waits for a lock, even while another thread is
+ * evaluating the deferred connections.
+ * What happens if the ring buffer is full is controlled by the OverflowPolicy.
+ *
+ * Only a single thread evaluates the deferred connections at a time.
+ * An evaluation only evaluates the invocations that were queued when it started, and the queue is not
+ * locked while the slots are running, so other threads can emit in the meantime.
+ * If another thread is currently evaluating the deferred connections, evaluateDeferredConnections() waits
+ * until it is done. If it is called by a slot that is currently being evaluated, it does nothing.
+ * Invocations of a connection that is disconnected after they were queued are skipped.
+ *
+ * All invocations share the same ring buffer, so they're evaluated in the order in which they were
+ * queued, regardless of the DeferredConnectionPriority of their connections.
+ *
+ * Conflated connections (see DeferredConnectionMode::Conflated) store their pending arguments
+ * outside of the ring buffer, so emitting them briefly takes a lock, which is however never held
+ * while slots are running.
+ *
+ * LockFreeConnectionEvaluator is not available if KDBindings is built with KDBINDINGS_SINGLE_THREADED.
+ *
+ * Example:
+ * @code
+ * auto evaluator = std::make_shared<LockFreeConnectionEvaluator>(4096, OverflowPolicy::DropOldest);
+ * (void)mySignal.connectDeferred(evaluator, [](int value) { ... });
+ * @endcode
+ *
+ * @see Signal::connectDeferred()
+ */
+class LockFreeConnectionEvaluator : public ConnectionEvaluator
+{
+public:
+    /** The capacity of the queue, unless another capacity is given to the constructor. */
+    static constexpr std::size_t DefaultCapacity = 1024;
+
+    /**
+     * Constructs a LockFreeConnectionEvaluator whose queue can store at least `capacity` slot invocations.
+     *
+     * The capacity is rounded up to the next power of two.
+     * All memory, including the overflow list of OverflowPolicy::Grow, is allocated from the given memory resource,
+     * which must outlive the LockFreeConnectionEvaluator.
+     */
+    explicit LockFreeConnectionEvaluator(std::size_t capacity = DefaultCapacity,
+                                         OverflowPolicy overflowPolicy = OverflowPolicy::Block,
+                                         pmr::memory_resource *resource = pmr::new_delete_resource())
+        : ConnectionEvaluator(resource)
+        , m_queue(capacity, resource)
+        , m_overflowPolicy(overflowPolicy)
+        , m_overflow(resource)
+        , m_overflowBatch(resource)
+    {
+    }
+
+    /** The number of slot invocations that fit into the queue. */
+    std::size_t capacity() const noexcept
+    {
+        return m_queue.capacity();
+    }
+
+    OverflowPolicy overflowPolicy() const noexcept
+    {
+        return m_overflowPolicy;
+    }
+
+    /**
+     * The number of slot invocations that were discarded because the queue was full,
+     * with OverflowPolicy::DropNewest or OverflowPolicy::DropOldest.
+     */
+    std::size_t droppedInvocations() const noexcept
+    {
+        return m_droppedInvocations.load(std::memory_order_relaxed);
+    }
+
+private:
+    // A queued invocation, together with the number of connections that were disconnected when it was queued.
+    struct Entry {
+        QueuedInvocation invocation;
+        std::size_t disconnects = 0;
+    };
+
+    class EvaluatingThreadGuard
+    {
+    public:
+        EvaluatingThreadGuard(std::atomic<std::thread::id> &evaluatingThread, std::thread::id thisThread) noexcept
+            : m_evaluatingThread(evaluatingThread)
+        {
+            m_evaluatingThread.store(thisThread);
+        }
+
+        ~EvaluatingThreadGuard() noexcept
+        {
+            m_evaluatingThread.store(std::thread::id());
+        }
+
+        EvaluatingThreadGuard(const EvaluatingThreadGuard &) = delete;
+        EvaluatingThreadGuard &operator=(const EvaluatingThreadGuard &) = delete;
+
+    private:
+        std::atomic<std::thread::id> &m_evaluatingThread;
+    };
+
+    std::size_t evaluateQueuedInvocations(const EvaluationBudget &budget) override
+    {
+        const auto thisThread = std::this_thread::get_id();
+        if (m_evaluatingThread.load() == thisThread) {
+            return remainingInvocations();
+        }
+        std::lock_guard<std::recursive_mutex> lock(m_evaluationMutex);
+        EvaluatingThreadGuard evaluatingThread(m_evaluatingThread, thisThread);
+        Private::TraceScope trace("evaluator", "LockFreeConnectionEvaluator::evaluateDeferredConnections", this);
+
+        std::size_t evaluatedInvocations = 0;
+
+        // Invocations that a limited evaluation left in the overflow batch are older than
+        // the invocations in the ring buffer, which were all queued after the batch was taken.
+        if (evaluateOverflowBatch(budget, evaluatedInvocations)) {
+            // Limit the evaluation to the invocations that are already queued,
+            // so that threads that keep emitting can't keep it running forever.
+            Entry entry;
+            for (auto remaining = m_queue.size(); remaining > 0 && budget.allows(evaluatedInvocations) && m_queue.tryPop(entry); --remaining) {
+                evaluatedInvocations += evaluate(entry);
+            }
+
+            // Invocations only go to the overflow list once the ring buffer was full, so they're newer
+            // than all invocations in the ring buffer and must only be evaluated once it is empty.
+            if (budget.allows(evaluatedInvocations) && m_overflowing.load() && m_queue.size() == 0) {
+                {
+                    std::lock_guard<std::mutex> overflowLock(m_overflowMutex);
+                    std::swap(m_overflow, m_overflowBatch);
+                    m_overflowing.store(false);
+                }
+                evaluateOverflowBatch(budget, evaluatedInvocations);
+            }
+        }
+
+        metricsRecorder().recordEvaluation(evaluatedInvocations, m_queue.size());
+        return remainingInvocations();
+    }
+
+    // Evaluates the rest of m_overflowBatch within the budget.
+    // Returns false if the budget ran out before all of them were evaluated.
+    bool evaluateOverflowBatch(const EvaluationBudget &budget, std::size_t &evaluatedInvocations)
+    {
+        try {
+            for (; m_firstOverflowBatchEntry < m_overflowBatch.size(); ++m_firstOverflowBatchEntry) {
+                if (!budget.allows(evaluatedInvocations)) {
+                    return false;
+                }
+                evaluatedInvocations += evaluate(m_overflowBatch[m_firstOverflowBatchEntry]);
+            }
+        } catch (...) {
+            // Best-effort: Don't execute the same erroneous slot multiple times.
+            m_overflowBatch.clear();
+            m_firstOverflowBatchEntry = 0;
+            throw;
+        }
+        m_overflowBatch.clear();
+        m_firstOverflowBatchEntry = 0;
+        return true;
+    }
+
+    // Only a snapshot, which may include invocations of disconnected connections.
+    // Must only be called by the evaluating thread.
+    std::size_t remainingInvocations()
+    {
+        std::lock_guard<std::mutex> overflowLock(m_overflowMutex);
+        return m_queue.size() + m_overflow.size() + (m_overflowBatch.size() - m_firstOverflowBatchEntry);
+    }
+
+    bool enqueue(const Private::GenerationalIndex &connection, SlotInvocation &&invocation) override
+    {
+        Entry entry{ QueuedInvocation(connection, std::move(invocation)), m_disconnects.load(std::memory_order_acquire) };
+
+        // Once invocations were stored in the overflow list, all following invocations must be
+        // stored there as well, so that they're evaluated in order.
+        while (!m_overflowing.load()) {
+            if (m_queue.tryPush(entry)) {
+                metricsRecorder().recordEnqueue(m_queue.size());
+                return true;
+            }
+
+            switch (m_overflowPolicy) {
+            case OverflowPolicy::Block:
+                if (m_evaluatingThread.load() == std::this_thread::get_id()) {
+                    return pushToOverflow(std::move(entry));
+                }
+                std::this_thread::yield();
+                break;
+            case OverflowPolicy::DropNewest:
+                m_droppedInvocations.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            case OverflowPolicy::DropOldest: {
+                Entry oldest;
+                if (m_queue.tryPop(oldest)) {
+                    if (!oldest.invocation.second) {
+                        discardConflatedInvocation(oldest.invocation.first);
+                    }
+                    m_droppedInvocations.fetch_add(1, std::memory_order_relaxed);
+                }
+                break;
+            }
+            case OverflowPolicy::Grow:
+                return pushToOverflow(std::move(entry));
+            }
+        }
+        return pushToOverflow(std::move(entry));
+    }
+
+    bool pushToOverflow(Entry &&entry)
+    {
+        std::lock_guard<std::mutex> lock(m_overflowMutex);
+        m_overflow.push_back(std::move(entry));
+        m_overflowing.store(true);
+        metricsRecorder().recordEnqueue(m_queue.size() + m_overflow.size());
+        return true;
+    }
+
+    // Evaluates the invocation, unless its connection was disconnected in the meantime.
+    // Returns the number of evaluated invocations.
+    //
+    // The connection of an invocation was connected when the invocation was queued. So unless any connection
+    // was disconnected since then, it still is, and the evaluation doesn't need to lock the registry.
+    std::size_t evaluate(Entry &entry)
+    {
+        auto &queuedInvocation = entry.invocation;
+        if (!queuedInvocation.second) {
+            // The placeholder of a conflated connection, which needs the registry lock.
+            std::lock_guard<std::recursive_mutex> lock(m_slotInvocationMutex);
+            takeConflatedInvocation(queuedInvocation);
+        } else if (m_disconnects.load(std::memory_order_acquire) != entry.disconnects && !isConnectionRegistered(queuedInvocation.first)) {
+            queuedInvocation.second.reset();
+        }
+        // Destroy the invocation right away, so that it doesn't keep its arguments alive.
+        auto invocation = std::move(queuedInvocation.second);
+        if (!invocation) {
+            return 0;
+        }
+        invocation();
+        return 1;
+    }
+
+    Private::BoundedQueue<Entry> m_queue;
+    const OverflowPolicy m_overflowPolicy;
+    std::atomic<std::size_t> m_droppedInvocations{ 0 };
+
+    // Whether m_overflow contains any invocations.
+    std::atomic<bool> m_overflowing{ false };
+    std::mutex m_overflowMutex;
+    Private::Vector<Entry> m_overflow;
+    // The overflow list that is currently being evaluated, which is swapped with m_overflow,
+    // so both keep their capacity.
+    Private::Vector<Entry> m_overflowBatch;
+    // The entries of m_overflowBatch before this one were already evaluated by a limited evaluation.
+    std::size_t m_firstOverflowBatchEntry = 0;
+
+    std::atomic<std::thread::id> m_evaluatingThread{ std::thread::id() };
+};
+
+} // namespace KDBindings
@@ -11,7 +11,9 @@
 
 #pragma once
 
+#include <kdbindings/memory_resource.h>
 #include <kdbindings/node.h>
+#include <memory>
 #include <type_traits>
 
 namespace KDBindings {
@@ -94,6 +96,44 @@ inline Node<ResultType> makeNode(Operator &&op, Ts &&...args)
             makeNode(std::forward<Ts>(args))...));
 }
 
+// Node creation helpers that allocate the nodes from the given memory resource.
+//
+// The arguments of an operator are turned into nodes that are allocated from the memory
+// resource as well, but Nodes that were already created are used as they are.
+template<typename T>
+inline Node<std::decay_t<T>> makeNode(std::allocator_arg_t, pmr::memory_resource *resource, T &&value)
+{
+    using NodeType = ConstantNode<std::decay_t<T>>;
+    return Node<std::decay_t<T>>(std::unique_ptr<NodeType>(new (resource) NodeType(std::move(value))));
+}
+
+template<typename T>
+inline Node<T> makeNode(std::allocator_arg_t, pmr::memory_resource *resource, Property<T> &property)
+{
+    return Node<T>(std::unique_ptr<PropertyNode<T>>(new (resource) PropertyNode<T>(property)));
+}
+
+template<typename T>
+inline Node<T> makeNode(std::allocator_arg_t, pmr::memory_resource *resource, const Property<T> &property)
+{
+    return Node<T>(std::unique_ptr<PropertyNode<T>>(new (resource) PropertyNode<T>(property)));
+}
+
+template<typename T>
+inline Node<T> makeNode(std::allocator_arg_t, pmr::memory_resource *, Node<T> &&node)
+{
+    return std::move(node);
+}
+
+template<typename Operator, typename... Ts, typename = std::enable_if_t<sizeof...(Ts) >= 1>, typename ResultType = operator_node_result_t<Operator, Ts...>>
+inline Node<ResultType> makeNode(std::allocator_arg_t, pmr::memory_resource *resource, Operator &&op, Ts &&...args)
+{
+    using NodeType = OperatorNode<ResultType, std::decay_t<Operator>, bindable_value_type_t<Ts>...>;
+    return Node<ResultType>(std::unique_ptr<NodeType>(new (resource) NodeType(
+            std::forward<Operator>(op),
+            makeNode(std::allocator_arg, resource, std::forward<Ts>(args))...)));
+}
+
 // Needed by function and operator helpers
 template<typename T>
 struct is_bindable : std::integral_constant<
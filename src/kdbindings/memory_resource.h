@@ -0,0 +1,253 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+
+namespace KDBindings {
+
+#if defined(__cpp_lib_memory_resource)
+
+/**
+ * The namespace of the memory resources that KDBindings allocates from.
+ *
+ * This is std::pmr, unless the standard library doesn't provide it (e.g. Apple platforms before macOS 14),
+ * in which case KDBindings::pmr provides memory_resource and new_delete_resource() itself.
+ */
+namespace pmr = std::pmr;
+
+#else
+
+namespace pmr {
+
+// A minimal replacement for pmr::memory_resource, for standard libraries that don't provide it.
+class memory_resource
+{
+public:
+    virtual ~memory_resource() = default;
+
+    void *allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
+    {
+        return do_allocate(bytes, alignment);
+    }
+
+    void deallocate(void *pointer, std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
+    {
+        do_deallocate(pointer, bytes, alignment);
+    }
+
+    bool is_equal(const memory_resource &other) const noexcept
+    {
+        return do_is_equal(other);
+    }
+
+private:
+    virtual void *do_allocate(std::size_t bytes, std::size_t alignment) = 0;
+    virtual void do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) = 0;
+    virtual bool do_is_equal(const memory_resource &other) const noexcept = 0;
+};
+
+inline bool operator==(const memory_resource &a, const memory_resource &b) noexcept
+{
+    return &a == &b || a.is_equal(b);
+}
+
+inline bool operator!=(const memory_resource &a, const memory_resource &b) noexcept
+{
+    return !(a == b);
+}
+
+inline memory_resource *new_delete_resource() noexcept
+{
+    class NewDeleteResource : public memory_resource
+    {
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            return ::operator new(bytes, std::align_val_t(alignment));
+        }
+
+        void do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) override
+        {
+            ::operator delete(pointer, bytes, std::align_val_t(alignment));
+        }
+
+        bool do_is_equal(const memory_resource &other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+    static NewDeleteResource resource;
+    return &resource;
+}
+
+} // namespace pmr
+
+#endif
+
+namespace Private {
+
+// An allocator that allocates from a pmr::memory_resource.
+//
+// Unlike pmr::polymorphic_allocator, the memory resource moves along with the container
+// when the container is assigned or swapped. This keeps move assignment of containers noexcept,
+// just like with std::allocator.
+//
+// A default constructed ResourceAllocator uses pmr::new_delete_resource().
+// KDBindings never uses the global default resource, as changing it isn't thread-safe,
+// so memory resources always have to be passed explicitly.
+template<typename T>
+class ResourceAllocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ResourceAllocator() noexcept
+        : m_resource(pmr::new_delete_resource())
+    {
+    }
+
+    ResourceAllocator(pmr::memory_resource *resource) noexcept
+        : m_resource(resource)
+    {
+    }
+
+    template<typename U>
+    ResourceAllocator(const ResourceAllocator<U> &other) noexcept
+        : m_resource(other.resource())
+    {
+    }
+
+    T *allocate(std::size_t count)
+    {
+        return static_cast<T *>(m_resource->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *pointer, std::size_t count) noexcept
+    {
+        m_resource->deallocate(pointer, count * sizeof(T), alignof(T));
+    }
+
+    pmr::memory_resource *resource() const noexcept { return m_resource; }
+
+    template<typename U>
+    bool operator==(const ResourceAllocator<U> &other) const noexcept
+    {
+        return *m_resource == *other.resource();
+    }
+
+    template<typename U>
+    bool operator!=(const ResourceAllocator<U> &other) const noexcept
+    {
+        return !(*this == other);
+    }
+
+private:
+    pmr::memory_resource *m_resource;
+};
+
+template<typename T>
+using Vector = std::vector<T, ResourceAllocator<T>>;
+
+// Deletes an object that was created with allocateUnique.
+// T must be the type of the object itself, not a base class of it.
+template<typename T>
+class ResourceDeleter
+{
+public:
+    ResourceDeleter() noexcept = default;
+
+    explicit ResourceDeleter(pmr::memory_resource *resource) noexcept
+        : m_resource(resource)
+    {
+    }
+
+    void operator()(T *object) const noexcept
+    {
+        object->~T();
+        m_resource->deallocate(object, sizeof(T), alignof(T));
+    }
+
+private:
+    pmr::memory_resource *m_resource = nullptr;
+};
+
+template<typename T>
+using ResourceUniquePtr = std::unique_ptr<T, ResourceDeleter<T>>;
+
+// The equivalent of std::make_unique, which allocates the object from the given memory resource.
+template<typename T, typename... Args>
+ResourceUniquePtr<T> allocateUnique(pmr::memory_resource *resource, Args &&...args)
+{
+    void *memory = resource->allocate(sizeof(T), alignof(T));
+    try {
+        return ResourceUniquePtr<T>(::new (memory) T(std::forward<Args>(args)...), ResourceDeleter<T>(resource));
+    } catch (...) {
+        resource->deallocate(memory, sizeof(T), alignof(T));
+        throw;
+    }
+}
+
+// Stored in front of allocations made by allocateWithHeader.
+struct ResourceHeader {
+    pmr::memory_resource *resource;
+    std::size_t size;
+    std::size_t alignment;
+
+    // The header is padded to the alignment of the object, so the object that follows it is aligned as well.
+    static constexpr std::size_t paddedSize(std::size_t alignment) noexcept
+    {
+        return (sizeof(ResourceHeader) + alignment - 1) / alignment * alignment;
+    }
+
+    static constexpr std::size_t allocationAlignment(std::size_t alignment) noexcept
+    {
+        return alignment < alignof(ResourceHeader) ? alignof(ResourceHeader) : alignment;
+    }
+};
+
+// Allocates memory from the given memory resource and remembers the resource in front
+// of the allocation, so deallocateWithHeader can return it to the same resource.
+//
+// This is used to implement class-specific operator new and delete for classes whose objects
+// are owned through a std::unique_ptr with the default deleter, which doesn't know the resource.
+inline void *allocateWithHeader(pmr::memory_resource *resource, std::size_t size, std::size_t alignment)
+{
+    alignment = ResourceHeader::allocationAlignment(alignment);
+    const std::size_t headerSize = ResourceHeader::paddedSize(alignment);
+
+    auto *object = static_cast<std::byte *>(resource->allocate(headerSize + size, alignment)) + headerSize;
+    ::new (static_cast<void *>(object - sizeof(ResourceHeader))) ResourceHeader{ resource, size, alignment };
+    return object;
+}
+
+inline void deallocateWithHeader(void *object) noexcept
+{
+    auto *header = std::launder(reinterpret_cast<ResourceHeader *>(static_cast<std::byte *>(object) - sizeof(ResourceHeader)));
+    const auto [resource, size, alignment] = *header;
+    const std::size_t headerSize = ResourceHeader::paddedSize(alignment);
+    resource->deallocate(static_cast<std::byte *>(object) - headerSize, headerSize + size, alignment);
+}
+
+} // namespace Private
+
+} // namespace KDBindings
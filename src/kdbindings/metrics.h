@@ -0,0 +1,439 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifndef KDBINDINGS_ENABLE_METRICS
+#include <kdbindings/metrics_recorder.h>
+#endif
+
+namespace KDBindings {
+
+/**
+ * @brief The metrics that were recorded for a Signal.
+ *
+ * @see MetricsRegistry
+ */
+struct SignalMetrics {
+    /** The name that was given to the Signal with Signal::setMetricsName, may be empty. */
+    std::string name;
+    /** Identifies the Signal for as long as it exists. */
+    const void *id = nullptr;
+    /** How often the Signal was emitted. Every value of an emitBatch counts as one emit. */
+    uint64_t emitCount = 0;
+    /** How many slots were called in total. */
+    uint64_t slotInvocations = 0;
+    /** How often a slot was not called because its connection was blocked. */
+    uint64_t blockedSkips = 0;
+    /**
+     * The largest number of connections whose slot was called by a single emit.
+     * For an emitBatch, every connection counts once, no matter how many values it received.
+     */
+    uint64_t maxFanOut = 0;
+    /** The time spent in all slots together. */
+    std::chrono::nanoseconds totalSlotTime{ 0 };
+    /** The longest time a single slot call took. */
+    std::chrono::nanoseconds maxSlotTime{ 0 };
+};
+
+/**
+ * @brief The metrics that were recorded for a ConnectionEvaluator.
+ *
+ * @see MetricsRegistry
+ */
+struct ConnectionEvaluatorMetrics {
+    /** The name that was given to the ConnectionEvaluator with ConnectionEvaluator::setMetricsName, may be empty. */
+    std::string name;
+    /** Identifies the ConnectionEvaluator for as long as it exists. */
+    const void *id = nullptr;
+    /** The number of slot invocations that are currently queued. */
+    uint64_t queueDepth = 0;
+    /** The largest number of slot invocations that were queued at the same time. */
+    uint64_t maxQueueDepth = 0;
+    /** How many slot invocations were queued in total. */
+    uint64_t enqueuedInvocations = 0;
+    /** How many slot invocations were evaluated in total. */
+    uint64_t evaluatedInvocations = 0;
+};
+
+namespace Private {
+
+class SignalMetricsRecorder;
+class ConnectionEvaluatorMetricsRecorder;
+
+} // namespace Private
+
+/**
+ * @brief The MetricsRegistry keeps track of the metrics of all Signals and ConnectionEvaluators.
+ *
+ * Metrics are only recorded if KDBindings is built with the KDBindings_ENABLE_METRICS CMake option
+ * (i.e. KDBINDINGS_ENABLE_METRICS is defined). Otherwise, the registry is always empty and
+ * recording metrics has no cost at all, neither in time nor in the size of Signals and ConnectionEvaluators.
+ *
+ * To write the metrics as JSON, include kdbindings/metrics_json.h and use writeMetricsJson().
+ *
+ * Signals are tracked once they have been connected to, or once they have been given a name
+ * with Signal::setMetricsName.
+ *
+ * The metrics can be read from any thread, while the Signals are emitted.
+ *
+ * Example:
+ * @code
+ * Signal<int> mySignal;
+ * mySignal.setMetricsName("mySignal");
+ * ...
+ * writeMetricsJsonFile("kdbindings-metrics.json");
+ * @endcode
+ */
+class MetricsRegistry
+{
+public:
+    /** Whether KDBindings was built with metrics enabled. */
+    static constexpr bool isEnabled() noexcept
+    {
+#ifdef KDBINDINGS_ENABLE_METRICS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /** Returns the MetricsRegistry that all Signals and ConnectionEvaluators are registered with. */
+    static MetricsRegistry &instance()
+    {
+        // The registry is never destroyed, so that Signals that are destroyed
+        // after the end of main can still unregister themselves.
+        // It is constructed in static storage, so recording metrics doesn't allocate.
+        alignas(MetricsRegistry) static unsigned char storage[sizeof(MetricsRegistry)];
+        static MetricsRegistry *registry = ::new (static_cast<void *>(storage)) MetricsRegistry();
+        return *registry;
+    }
+
+    MetricsRegistry(const MetricsRegistry &) = delete;
+    MetricsRegistry &operator=(const MetricsRegistry &) = delete;
+
+    /** Returns the metrics of all Signals that currently exist. */
+    inline std::vector<SignalMetrics> signalMetrics() const;
+
+    /** Returns the metrics of all ConnectionEvaluators that currently exist. */
+    inline std::vector<ConnectionEvaluatorMetrics> connectionEvaluatorMetrics() const;
+
+private:
+    friend class Private::SignalMetricsRecorder;
+    friend class Private::ConnectionEvaluatorMetricsRecorder;
+
+    MetricsRegistry() = default;
+
+    // The recorders form intrusive doubly linked lists, so registering and
+    // unregistering does not need to allocate or search.
+    struct Node {
+        Node *previous = nullptr;
+        Node *next = nullptr;
+    };
+
+    void add(Node &list, Node &node)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        node.previous = &list;
+        node.next = list.next;
+        if (list.next) {
+            list.next->previous = &node;
+        }
+        list.next = &node;
+    }
+
+    void remove(Node &node) noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        node.previous->next = node.next;
+        if (node.next) {
+            node.next->previous = node.previous;
+        }
+    }
+
+    mutable std::mutex m_mutex;
+    Node m_signals;
+    Node m_connectionEvaluators;
+};
+
+namespace Private {
+
+// A counter that is only written by a single thread at a time, but may be read from any thread.
+// Incrementing it with a relaxed load and store avoids the cost of an atomic read-modify-write.
+class MetricsCounter
+{
+public:
+    void add(uint64_t amount) noexcept
+    {
+        m_value.store(m_value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    void set(uint64_t value) noexcept
+    {
+        m_value.store(value, std::memory_order_relaxed);
+    }
+
+    void max(uint64_t value) noexcept
+    {
+        if (value > m_value.load(std::memory_order_relaxed)) {
+            m_value.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t get() const noexcept
+    {
+        return m_value.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> m_value{ 0 };
+};
+
+// A counter that may be written by several threads at the same time.
+class ConcurrentMetricsCounter
+{
+public:
+    void add(uint64_t amount) noexcept
+    {
+        m_value.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    void set(uint64_t value) noexcept
+    {
+        m_value.store(value, std::memory_order_relaxed);
+    }
+
+    void max(uint64_t value) noexcept
+    {
+        auto current = m_value.load(std::memory_order_relaxed);
+        while (value > current && !m_value.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t get() const noexcept
+    {
+        return m_value.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> m_value{ 0 };
+};
+
+#ifdef KDBINDINGS_ENABLE_METRICS
+
+// Records the metrics of a single Signal and registers them with the MetricsRegistry.
+class SignalMetricsRecorder : private MetricsRegistry::Node
+{
+public:
+    SignalMetricsRecorder()
+    {
+        MetricsRegistry::instance().add(MetricsRegistry::instance().m_signals, *this);
+    }
+
+    ~SignalMetricsRecorder()
+    {
+        MetricsRegistry::instance().remove(*this);
+    }
+
+    SignalMetricsRecorder(const SignalMetricsRecorder &) = delete;
+    SignalMetricsRecorder &operator=(const SignalMetricsRecorder &) = delete;
+
+    void setName(std::string_view name)
+    {
+        std::lock_guard<std::mutex> lock(MetricsRegistry::instance().m_mutex);
+        m_name = name;
+    }
+
+    // Records a single emit (or emitBatch) while it is alive.
+    class EmitRecord
+    {
+    public:
+        EmitRecord(SignalMetricsRecorder &recorder, std::size_t emitCount) noexcept
+            : m_recorder(recorder), m_emitCount(emitCount)
+        {
+        }
+
+        ~EmitRecord()
+        {
+            m_recorder.m_emitCount.add(m_emitCount);
+            m_recorder.m_slotInvocations.add(m_slotInvocations);
+            m_recorder.m_blockedSkips.add(m_blockedSkips);
+            m_recorder.m_maxFanOut.max(m_invokedConnections);
+        }
+
+        EmitRecord(const EmitRecord &) = delete;
+        EmitRecord &operator=(const EmitRecord &) = delete;
+
+        void blockedSkip() noexcept { ++m_blockedSkips; }
+
+        // Called once for every connection whose slot is called, before its slot calls.
+        // An emitBatch calls the slot of a connection for every value, but that still counts as one connection.
+        void connectionInvoked() noexcept { ++m_invokedConnections; }
+
+        template<typename Func>
+        void invoke(Func &&slotCall)
+        {
+            // The end of one slot call is used as the start of the next one, so that reading the clock,
+            // which is the main cost of the metrics, only happens once per slot.
+            if (m_slotInvocations++ == 0) {
+                m_timestamp = std::chrono::steady_clock::now();
+            }
+            slotCall();
+            const auto end = std::chrono::steady_clock::now();
+            const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - m_timestamp);
+            m_timestamp = end;
+            m_recorder.m_totalSlotTime.add(static_cast<uint64_t>(elapsed.count()));
+            m_recorder.m_maxSlotTime.max(static_cast<uint64_t>(elapsed.count()));
+        }
+
+    private:
+        SignalMetricsRecorder &m_recorder;
+        std::size_t m_emitCount;
+        uint64_t m_slotInvocations = 0;
+        uint64_t m_blockedSkips = 0;
+        uint64_t m_invokedConnections = 0;
+        std::chrono::steady_clock::time_point m_timestamp;
+    };
+
+    EmitRecord recordEmit(std::size_t emitCount = 1) noexcept
+    {
+        return EmitRecord(*this, emitCount);
+    }
+
+private:
+    friend class KDBindings::MetricsRegistry;
+
+    SignalMetrics metrics() const
+    {
+        SignalMetrics metrics;
+        metrics.name = m_name;
+        metrics.id = static_cast<const void *>(this);
+        metrics.emitCount = m_emitCount.get();
+        metrics.slotInvocations = m_slotInvocations.get();
+        metrics.blockedSkips = m_blockedSkips.get();
+        metrics.maxFanOut = m_maxFanOut.get();
+        metrics.totalSlotTime = std::chrono::nanoseconds(m_totalSlotTime.get());
+        metrics.maxSlotTime = std::chrono::nanoseconds(m_maxSlotTime.get());
+        return metrics;
+    }
+
+    std::string m_name;
+    MetricsCounter m_emitCount;
+    MetricsCounter m_slotInvocations;
+    MetricsCounter m_blockedSkips;
+    MetricsCounter m_maxFanOut;
+    MetricsCounter m_totalSlotTime;
+    MetricsCounter m_maxSlotTime;
+};
+
+// Records the metrics of a single ConnectionEvaluator and registers them with the MetricsRegistry.
+// Evaluators like the LockFreeConnectionEvaluator record enqueues from every emitting thread
+// without holding a lock, so all counters must support concurrent writers.
+class ConnectionEvaluatorMetricsRecorder : private MetricsRegistry::Node
+{
+public:
+    ConnectionEvaluatorMetricsRecorder()
+    {
+        MetricsRegistry::instance().add(MetricsRegistry::instance().m_connectionEvaluators, *this);
+    }
+
+    ~ConnectionEvaluatorMetricsRecorder()
+    {
+        MetricsRegistry::instance().remove(*this);
+    }
+
+    ConnectionEvaluatorMetricsRecorder(const ConnectionEvaluatorMetricsRecorder &) = delete;
+    ConnectionEvaluatorMetricsRecorder &operator=(const ConnectionEvaluatorMetricsRecorder &) = delete;
+
+    void setName(std::string_view name)
+    {
+        std::lock_guard<std::mutex> lock(MetricsRegistry::instance().m_mutex);
+        m_name = name;
+    }
+
+    void recordEnqueue(std::size_t queueDepth) noexcept
+    {
+        m_enqueuedInvocations.add(1);
+        m_queueDepth.set(queueDepth);
+        m_maxQueueDepth.max(queueDepth);
+    }
+
+    void recordDequeue(std::size_t queueDepth) noexcept
+    {
+        m_queueDepth.set(queueDepth);
+    }
+
+    void recordEvaluation(std::size_t evaluatedInvocations, std::size_t queueDepth) noexcept
+    {
+        m_evaluatedInvocations.add(evaluatedInvocations);
+        m_queueDepth.set(queueDepth);
+    }
+
+private:
+    friend class KDBindings::MetricsRegistry;
+
+    ConnectionEvaluatorMetrics metrics() const
+    {
+        ConnectionEvaluatorMetrics metrics;
+        metrics.name = m_name;
+        metrics.id = static_cast<const void *>(this);
+        metrics.queueDepth = m_queueDepth.get();
+        metrics.maxQueueDepth = m_maxQueueDepth.get();
+        metrics.enqueuedInvocations = m_enqueuedInvocations.get();
+        metrics.evaluatedInvocations = m_evaluatedInvocations.get();
+        return metrics;
+    }
+
+    std::string m_name;
+    ConcurrentMetricsCounter m_queueDepth;
+    ConcurrentMetricsCounter m_maxQueueDepth;
+    ConcurrentMetricsCounter m_enqueuedInvocations;
+    ConcurrentMetricsCounter m_evaluatedInvocations;
+};
+
+#endif
+
+} // namespace Private
+
+std::vector<SignalMetrics> MetricsRegistry::signalMetrics() const
+{
+    std::vector<SignalMetrics> result;
+#ifdef KDBINDINGS_ENABLE_METRICS
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto *node = m_signals.next; node; node = node->next) {
+        result.push_back(static_cast<const Private::SignalMetricsRecorder *>(node)->metrics());
+    }
+#endif
+    return result;
+}
+
+std::vector<ConnectionEvaluatorMetrics> MetricsRegistry::connectionEvaluatorMetrics() const
+{
+    std::vector<ConnectionEvaluatorMetrics> result;
+#ifdef KDBINDINGS_ENABLE_METRICS
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto *node = m_connectionEvaluators.next; node; node = node->next) {
+        result.push_back(static_cast<const Private::ConnectionEvaluatorMetricsRecorder *>(node)->metrics());
+    }
+#endif
+    return result;
+}
+
+} // namespace KDBindings
@@ -0,0 +1,113 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include <kdbindings/metrics.h>
+
+namespace KDBindings {
+
+namespace Private {
+
+inline std::string jsonString(std::string_view text)
+{
+    std::string result = "\"";
+    for (const char c : text) {
+        switch (c) {
+        case '"':
+            result += "\\\"";
+            break;
+        case '\\':
+            result += "\\\\";
+            break;
+        case '\n':
+            result += "\\n";
+            break;
+        case '\t':
+            result += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                result += escaped;
+            } else {
+                result += c;
+            }
+        }
+    }
+    result += '"';
+    return result;
+}
+
+} // namespace Private
+
+/**
+ * Writes the metrics of all Signals and ConnectionEvaluators in the MetricsRegistry
+ * as a JSON object to the stream.
+ *
+ * This lives in its own header, so that Signals don't need to include the stream headers.
+ */
+inline void writeMetricsJson(std::ostream &stream)
+{
+    const auto signals = MetricsRegistry::instance().signalMetrics();
+    const auto evaluators = MetricsRegistry::instance().connectionEvaluatorMetrics();
+
+    stream << "{\n  \"signals\": [";
+    for (std::size_t i = 0; i < signals.size(); ++i) {
+        const auto &metrics = signals[i];
+        stream << (i == 0 ? "\n" : ",\n")
+               << "    { \"name\": " << Private::jsonString(metrics.name)
+               << ", \"id\": \"" << metrics.id << '"'
+               << ", \"emitCount\": " << metrics.emitCount
+               << ", \"slotInvocations\": " << metrics.slotInvocations
+               << ", \"blockedSkips\": " << metrics.blockedSkips
+               << ", \"maxFanOut\": " << metrics.maxFanOut
+               << ", \"totalSlotTimeNs\": " << metrics.totalSlotTime.count()
+               << ", \"maxSlotTimeNs\": " << metrics.maxSlotTime.count() << " }";
+    }
+    stream << (signals.empty() ? "" : "\n  ") << "],\n  \"connectionEvaluators\": [";
+    for (std::size_t i = 0; i < evaluators.size(); ++i) {
+        const auto &metrics = evaluators[i];
+        stream << (i == 0 ? "\n" : ",\n")
+               << "    { \"name\": " << Private::jsonString(metrics.name)
+               << ", \"id\": \"" << metrics.id << '"'
+               << ", \"queueDepth\": " << metrics.queueDepth
+               << ", \"maxQueueDepth\": " << metrics.maxQueueDepth
+               << ", \"enqueuedInvocations\": " << metrics.enqueuedInvocations
+               << ", \"evaluatedInvocations\": " << metrics.evaluatedInvocations << " }";
+    }
+    stream << (evaluators.empty() ? "" : "\n  ") << "]\n}\n";
+}
+
+/**
+ * Writes the metrics as JSON (see writeMetricsJson) to the given file.
+ *
+ * @return whether the file could be written.
+ */
+inline bool writeMetricsJsonFile(const std::string &fileName)
+{
+    std::ofstream file(fileName, std::ios::out | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    writeMetricsJson(file);
+    file.flush();
+    return static_cast<bool>(file);
+}
+
+} // namespace KDBindings
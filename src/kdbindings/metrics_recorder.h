@@ -0,0 +1,73 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#pragma once
+
+// Signals and ConnectionEvaluators only include this header, so that the MetricsRegistry and
+// everything it needs are only included if KDBindings is built with metrics enabled.
+
+#ifdef KDBINDINGS_ENABLE_METRICS
+
+#include <kdbindings/metrics.h>
+
+namespace KDBindings {
+namespace Private {
+inline constexpr bool MetricsEnabled = true;
+} // namespace Private
+} // namespace KDBindings
+
+#else
+
+#include <cstddef>
+#include <string_view>
+
+namespace KDBindings {
+
+namespace Private {
+
+inline constexpr bool MetricsEnabled = false;
+
+// Without KDBINDINGS_ENABLE_METRICS, the recorders are empty and all of their functions do nothing,
+// so the compiler removes them entirely.
+class SignalMetricsRecorder
+{
+public:
+    void setName(std::string_view) noexcept { }
+
+    class EmitRecord
+    {
+    public:
+        void blockedSkip() noexcept { }
+        void connectionInvoked() noexcept { }
+
+        template<typename Func>
+        void invoke(Func &&slotCall)
+        {
+            slotCall();
+        }
+    };
+
+    EmitRecord recordEmit(std::size_t = 1) noexcept { return {}; }
+};
+
+class ConnectionEvaluatorMetricsRecorder
+{
+public:
+    void setName(std::string_view) noexcept { }
+    void recordEnqueue(std::size_t) noexcept { }
+    void recordDequeue(std::size_t) noexcept { }
+    void recordEvaluation(std::size_t, std::size_t) noexcept { }
+};
+
+} // namespace Private
+
+} // namespace KDBindings
+
+#endif
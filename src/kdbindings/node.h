@@ -11,11 +11,14 @@
 
 #pragma once
 
+#include <kdbindings/memory_resource.h>
 #include <kdbindings/property.h>
 #include <kdbindings/signal.h>
 
+#include <cstddef>
 #include <functional>
 #include <memory>
+#include <new>
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
@@ -43,6 +46,51 @@ public:
 
     Dirtyable() = default;
 
+    // Nodes and Bindings are owned by std::unique_ptrs with the default deleter, so they remember
+    // the memory resource they were allocated from in front of the object.
+    // They are allocated with pmr::new_delete_resource(), unless a memory resource is passed
+    // to makeNode or makeBinding with std::allocator_arg, which uses the placement forms below.
+    static void *operator new(std::size_t size)
+    {
+        return allocateWithHeader(pmr::new_delete_resource(), size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+    }
+
+    static void *operator new(std::size_t size, std::align_val_t alignment)
+    {
+        return allocateWithHeader(pmr::new_delete_resource(), size, static_cast<std::size_t>(alignment));
+    }
+
+    static void *operator new(std::size_t size, pmr::memory_resource *resource)
+    {
+        return allocateWithHeader(resource, size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+    }
+
+    static void *operator new(std::size_t size, std::align_val_t alignment, pmr::memory_resource *resource)
+    {
+        return allocateWithHeader(resource, size, static_cast<std::size_t>(alignment));
+    }
+
+    static void operator delete(void *object) noexcept
+    {
+        deallocateWithHeader(object);
+    }
+
+    static void operator delete(void *object, std::align_val_t) noexcept
+    {
+        deallocateWithHeader(object);
+    }
+
+    // Called if the constructor of an object that was allocated from a memory resource throws.
+    static void operator delete(void *object, pmr::memory_resource *) noexcept
+    {
+        deallocateWithHeader(object);
+    }
+
+    static void operator delete(void *object, std::align_val_t, pmr::memory_resource *) noexcept
+    {
+        deallocateWithHeader(object);
+    }
+
     void setParent(Dirtyable *newParent)
     {
         auto **parentVar = parentVariable();
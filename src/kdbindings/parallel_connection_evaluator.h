@@ -0,0 +1,365 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <kdbindings/connection_evaluator.h>
+#include <kdbindings/genindex_array.h>
+#include <kdbindings/memory_resource.h>
+#include <kdbindings/tracing.h>
+#include <kdbindings/utils.h>
+
+#include <kdbindings/KDBindingsConfig.h>
+
+#ifdef KDBINDINGS_SINGLE_THREADED
+#error "ParallelConnectionEvaluator is not available when KDBindings is built with KDBINDINGS_SINGLE_THREADED"
+#endif
+
+namespace KDBindings {
+
+/**
+ * @brief A ConnectionEvaluator that evaluates the deferred connections on a pool of threads.
+ *
+ * @warning Deferred connections are experimental and may be removed or changed in the future.
+ *
+ * When the deferred connections are evaluated, the queued invocations of each connection are
+ * evaluated in the order in which they were queued, one after the other.
+ * Invocations of different connections are evaluated in parallel, by the threads of the pool
+ * and the thread that calls evaluateDeferredConnections().
+ * Threads that run out of work take the remaining work of other threads (work stealing).
+ *
+ * The connections are distributed in the order of their DeferredConnectionPriority, but as they
+ * are evaluated in parallel, a lower priority connection may be evaluated before a higher priority one.
+ *
+ * This is useful if the deferred slots do CPU-heavy work, like decoding images or parsing files.
+ * Slots of different connections must therefore be safe to run concurrently.
+ *
+ * Signals can be emitted while the deferred connections are evaluated, the invocations are queued
+ * for the next evaluation.
+ * If another thread is currently evaluating the deferred connections, evaluateDeferredConnections() waits
+ * until it is done. If it is called by a slot that is currently being evaluated, it does nothing.
+ *
+ * If a slot throws an exception, the remaining invocations of its connection are discarded,
+ * and the exception is rethrown once all other invocations have been evaluated.
+ *
+ * ParallelConnectionEvaluator is not available if KDBindings is built with KDBINDINGS_SINGLE_THREADED.
+ *
+ * @see Signal::connectDeferred()
+ */
+class ParallelConnectionEvaluator : public ConnectionEvaluator
+{
+public:
+    /**
+     * Constructs a ParallelConnectionEvaluator with a pool of `threadCount` threads.
+     *
+     * The thread that calls evaluateDeferredConnections() evaluates invocations as well,
+     * so up to `threadCount + 1` slots run in parallel.
+     * By default, the pool uses one thread less than std::thread::hardware_concurrency().
+     *
+     * The queued invocations are allocated from the given memory resource,
+     * which must outlive the ParallelConnectionEvaluator.
+     */
+    explicit ParallelConnectionEvaluator(unsigned threadCount = defaultThreadCount(),
+                                         pmr::memory_resource *resource = pmr::new_delete_resource())
+        : ConnectionEvaluator(resource)
+        , m_nextInvocation(resource)
+        , m_processedInvocations(resource)
+        , m_lastInvocationOfConnection(resource)
+        , m_tasks(resource)
+        , m_taskRanges(threadCount + 1, Private::ResourceAllocator<TaskRange>(resource))
+    {
+        m_threads.reserve(threadCount);
+        try {
+            for (unsigned i = 0; i < threadCount; ++i) {
+                m_threads.emplace_back([this, i]() { runWorker(i); });
+            }
+        } catch (...) {
+            stopWorkers();
+            throw;
+        }
+    }
+
+    ~ParallelConnectionEvaluator() override
+    {
+        stopWorkers();
+    }
+
+    /** The number of threads in the pool. */
+    unsigned threadCount() const noexcept
+    {
+        return static_cast<unsigned>(m_threads.size());
+    }
+
+private:
+    using Entry = std::pair<Private::GenerationalIndex, SlotInvocation>;
+
+    static constexpr std::size_t NoInvocation = (std::numeric_limits<std::size_t>::max)();
+
+    // The tasks of a single thread, which other threads can steal from.
+    // The owner takes tasks from the front, thieves take them from the back.
+    struct alignas(Private::CacheLineSize) TaskRange {
+        std::mutex mutex;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+    };
+
+    static unsigned defaultThreadCount() noexcept
+    {
+        const auto hardwareThreads = std::thread::hardware_concurrency();
+        return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    std::size_t evaluateQueuedInvocations(const EvaluationBudget &budget) override
+    {
+        if (t_evaluatingEvaluator == this) {
+            return remainingInvocations();
+        }
+        std::lock_guard<std::recursive_mutex> evaluationLock(m_evaluationMutex);
+        Private::TraceScope trace("evaluator", "ParallelConnectionEvaluator::evaluateDeferredConnections", this);
+
+        takeBatch(budget.maxInvocations);
+        if (m_tasks.empty()) {
+            finishBatch();
+            return remainingInvocations();
+        }
+
+        m_budget = &budget;
+        m_evaluatedInvocations.store(0, std::memory_order_relaxed);
+        m_remainingTasks.store(m_tasks.size());
+        distributeTasks();
+        {
+            std::lock_guard<std::mutex> lock(m_poolMutex);
+            ++m_generation;
+        }
+        m_workAvailable.notify_all();
+
+        runTasks(m_taskRanges.size() - 1);
+        {
+            std::unique_lock<std::mutex> lock(m_poolMutex);
+            m_allTasksDone.wait(lock, [this]() { return m_remainingTasks.load() == 0; });
+        }
+        m_budget = nullptr;
+
+        finishBatch();
+        std::size_t remaining;
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_slotInvocationMutex);
+            metricsRecorder().recordEvaluation(m_evaluatedInvocations.load(std::memory_order_relaxed), m_queueDepth);
+            remaining = m_queueDepth;
+        }
+
+        std::exception_ptr exception;
+        std::swap(exception, m_exception);
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+        return remaining;
+    }
+
+    // Moves the queued invocations into m_batch and links the invocations of each connection,
+    // so that every connection becomes a single task, which evaluates its invocations in order.
+    void takeBatch(std::size_t maxInvocations)
+    {
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_slotInvocationMutex);
+            fillBatch(maxInvocations);
+            m_lastInvocationOfConnection.assign(m_connections.entriesSize(), NoInvocation);
+        }
+
+        const auto batchSize = m_batch.size();
+        m_tasks.clear();
+        m_nextInvocation.assign(batchSize, NoInvocation);
+        m_processedInvocations.assign(batchSize, false);
+        for (std::size_t i = 0; i < batchSize; ++i) {
+            auto &last = m_lastInvocationOfConnection[m_batch[i].first.index];
+            if (last == NoInvocation) {
+                m_tasks.push_back(i);
+            } else {
+                m_nextInvocation[last] = i;
+            }
+            last = i;
+        }
+    }
+
+    // Removes the invocations that were processed from m_batch.
+    // Invocations that weren't processed, because the time budget ran out, are returned to their lanes in order.
+    void finishBatch()
+    {
+        const auto batchEnd = m_batchBegin + m_processedInvocations.size();
+        auto firstRemaining = batchEnd;
+        for (auto i = batchEnd; i-- > m_batchBegin;) {
+            if (!m_processedInvocations[i - m_batchBegin]) {
+                --firstRemaining;
+                if (firstRemaining != i) {
+                    m_batch[firstRemaining] = std::move(m_batch[i]);
+                }
+            }
+        }
+        m_processedInvocations.clear();
+
+        m_batchBegin = firstRemaining;
+        std::lock_guard<std::recursive_mutex> lock(m_slotInvocationMutex);
+        returnBatchInvocations();
+    }
+
+    void distributeTasks()
+    {
+        const auto rangeCount = m_taskRanges.size();
+        const auto tasksPerRange = m_tasks.size() / rangeCount;
+        const auto remainder = m_tasks.size() % rangeCount;
+        std::size_t begin = 0;
+        for (std::size_t i = 0; i < rangeCount; ++i) {
+            const auto end = begin + tasksPerRange + (i < remainder ? 1 : 0);
+            std::lock_guard<std::mutex> lock(m_taskRanges[i].mutex);
+            m_taskRanges[i].begin = begin;
+            m_taskRanges[i].end = end;
+            begin = end;
+        }
+    }
+
+    // Takes the next task from the own range, or steals one from another range.
+    std::size_t takeTask(std::size_t ownRange)
+    {
+        {
+            auto &range = m_taskRanges[ownRange];
+            std::lock_guard<std::mutex> lock(range.mutex);
+            if (range.begin < range.end) {
+                return m_tasks[range.begin++];
+            }
+        }
+        for (std::size_t offset = 1; offset < m_taskRanges.size(); ++offset) {
+            auto &range = m_taskRanges[(ownRange + offset) % m_taskRanges.size()];
+            std::lock_guard<std::mutex> lock(range.mutex);
+            if (range.begin < range.end) {
+                return m_tasks[--range.end];
+            }
+        }
+        return NoInvocation;
+    }
+
+    void runTasks(std::size_t ownRange)
+    {
+        // A slot may evaluate another ParallelConnectionEvaluator, so restore the previous one afterwards.
+        const auto *previousEvaluator = t_evaluatingEvaluator;
+        t_evaluatingEvaluator = this;
+        for (auto task = takeTask(ownRange); task != NoInvocation; task = takeTask(ownRange)) {
+            runTask(task);
+            if (m_remainingTasks.fetch_sub(1) == 1) {
+                // Lock the mutex, so that the notification can't get lost between the
+                // check of the waiting thread and its wait.
+                std::lock_guard<std::mutex> lock(m_poolMutex);
+                m_allTasksDone.notify_all();
+            }
+        }
+        t_evaluatingEvaluator = previousEvaluator;
+    }
+
+    // Evaluates the invocations of a single connection, in order.
+    void runTask(std::size_t invocation) noexcept
+    {
+        try {
+            for (; invocation != NoInvocation; invocation = m_nextInvocation[invocation]) {
+                if (m_budget->isExpired()) {
+                    return;
+                }
+                m_processedInvocations[invocation] = true;
+                auto &queuedInvocation = m_batch[m_batchBegin + invocation];
+                if (isStillConnected(queuedInvocation)) {
+                    queuedInvocation.second();
+                    m_evaluatedInvocations.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> lock(m_poolMutex);
+                if (!m_exception) {
+                    m_exception = std::current_exception();
+                }
+            }
+            // Discard the remaining invocations of the connection.
+            for (invocation = m_nextInvocation[invocation]; invocation != NoInvocation; invocation = m_nextInvocation[invocation]) {
+                m_processedInvocations[invocation] = true;
+            }
+        }
+    }
+
+    void runWorker(std::size_t ownRange)
+    {
+        uint64_t generation = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_poolMutex);
+                m_workAvailable.wait(lock, [&]() { return m_stopping || m_generation != generation; });
+                if (m_stopping) {
+                    return;
+                }
+                generation = m_generation;
+            }
+            runTasks(ownRange);
+        }
+    }
+
+    void stopWorkers() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_poolMutex);
+            m_stopping = true;
+        }
+        m_workAvailable.notify_all();
+        for (auto &thread : m_threads) {
+            thread.join();
+        }
+        m_threads.clear();
+    }
+
+    // The ParallelConnectionEvaluator whose invocations the current thread is evaluating, if any.
+    static inline thread_local const ParallelConnectionEvaluator *t_evaluatingEvaluator = nullptr;
+
+    // For every invocation that is currently being evaluated, the next invocation of the same connection.
+    // Like the tasks, these are relative to m_batchBegin.
+    Private::Vector<std::size_t> m_nextInvocation;
+    // For every invocation that is currently being evaluated, whether it was evaluated or discarded.
+    // Each thread only writes the elements of its own tasks, so this must not be a std::vector<bool>.
+    Private::Vector<char> m_processedInvocations;
+    // Indexed by the index of the connection, only needed while building the tasks.
+    Private::Vector<std::size_t> m_lastInvocationOfConnection;
+    // The first invocation of every connection in m_batch.
+    Private::Vector<std::size_t> m_tasks;
+    // One range of tasks per pool thread, and one for the thread that evaluates.
+    Private::Vector<TaskRange> m_taskRanges;
+
+    // The budget of the current evaluation.
+    const EvaluationBudget *m_budget = nullptr;
+    std::atomic<std::size_t> m_remainingTasks{ 0 };
+    std::atomic<std::size_t> m_evaluatedInvocations{ 0 };
+    // Guarded by m_poolMutex.
+    std::exception_ptr m_exception;
+
+    std::mutex m_poolMutex;
+    std::condition_variable m_workAvailable;
+    std::condition_variable m_allTasksDone;
+    uint64_t m_generation = 0;
+    bool m_stopping = false;
+    std::vector<std::thread> m_threads;
+};
+
+} // namespace KDBindings
@@ -13,6 +13,7 @@
 
 #include <kdbindings/property_updater.h>
 #include <kdbindings/signal.h>
+#include <kdbindings/tracing.h>
 
 #include <iostream>
 #include <memory>
@@ -162,6 +163,24 @@ public:
     {
     }
 
+    /**
+     * Constructs a Property from the provided value, whose Signals allocate all of their
+     * memory from the given memory resource.
+     *
+     * This includes the connections that Bindings make to the Property.
+     * The memory resource must outlive the Property.
+     *
+     * @see Signal(pmr::memory_resource *)
+     */
+    Property(std::allocator_arg_t, pmr::memory_resource *resource, T value = T{})
+        : m_value{ std::move(value) }
+        , m_valueAboutToChange(resource)
+        , m_valueChanged(resource)
+        , m_moved(resource)
+        , m_destroyed(resource)
+    {
+    }
+
     /**
      * Properties are not copyable.
      */
@@ -189,9 +208,7 @@ public:
 
         // If we have an updater, let it know how to update our internal value
         if (m_updater) {
-            using namespace std::placeholders;
-            m_updater->setUpdateFunction(
-                    std::bind(&Property<T>::setHelper, this, _1));
+            m_updater->setUpdateFunction(updateFunction());
         }
 
         // Emit the moved signals for the moved from and moved to properties
@@ -215,9 +232,7 @@ public:
 
         // If we have an updater, let it know how to update our internal value
         if (m_updater) {
-            using namespace std::placeholders;
-            m_updater->setUpdateFunction(
-                    std::bind(&Property<T>::setHelper, this, _1));
+            m_updater->setUpdateFunction(updateFunction());
         }
 
         // Emit the moved signals for the moved from and moved to properties
@@ -257,9 +272,7 @@ public:
         m_updater = std::move(updater);
 
         // Let the updater know how to update our internal value
-        using namespace std::placeholders;
-        m_updater->setUpdateFunction(
-                std::bind(&Property<T>::setHelper, this, _1));
+        m_updater->setUpdateFunction(updateFunction());
 
         // Now synchronise our value with whatever the updator has right now.
         setHelper(m_updater->get());
@@ -343,6 +356,17 @@ public:
      * See: set().
      */
     Property<T> &operator=(T const &rhs)
+    {
+        set(rhs);
+        return *this;
+    }
+
+    /**
+     * Assigns a new value to this Property, without copying it.
+     *
+     * See: set().
+     */
+    Property<T> &operator=(T &&rhs)
     {
         set(std::move(rhs));
         return *this;
@@ -359,11 +383,19 @@ public:
     }
 
 private:
-    void setHelper(T value)
+    // The function that the updater calls to set the value of this Property.
+    // Unlike std::bind, the lambda only captures a pointer, so std::function can store it without allocating.
+    auto updateFunction()
+    {
+        return [this](T &&value) { setHelper(std::move(value)); };
+    }
+
+    void setHelper(T &&value)
     {
         if (equal_to<T>{}(value, m_value))
             return;
 
+        Private::TraceScope trace("property", "Property::set", this);
         m_valueAboutToChange.emit(m_value, value);
         m_value = std::move(value);
         m_valueChanged.emit(m_value);
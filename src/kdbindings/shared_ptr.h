@@ -0,0 +1,433 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#pragma once
+
+#include <kdbindings/memory_resource.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace KDBindings {
+
+namespace Private {
+
+template<typename T>
+class LocalSharedPtr;
+
+template<typename T>
+class LocalWeakPtr;
+
+template<typename T, typename... Args>
+LocalSharedPtr<T> allocateLocalShared(pmr::memory_resource *resource, Args &&...args);
+
+// The reference counts of an object created by allocateLocalShared.
+// Unlike the control block of std::shared_ptr, the counts are not atomic,
+// so LocalSharedPtr and LocalWeakPtr must only be used by a single thread.
+//
+// The weak count includes one reference for all strong references together,
+// so the control block outlives the object as long as there are any references.
+//
+// The counts are kept in a control block instead of an intrusive count in the shared classes,
+// so that LocalSharedPtr can offer the same interface as std::shared_ptr, including weak pointers,
+// and KDBindings can switch between the two without changing the classes that are shared.
+// Like with std::allocate_shared, the control block and the object are a single allocation.
+class LocalControlBlock
+{
+public:
+    LocalControlBlock() = default;
+    LocalControlBlock(const LocalControlBlock &) = delete;
+    LocalControlBlock &operator=(const LocalControlBlock &) = delete;
+
+    virtual ~LocalControlBlock() = default;
+
+    void retain() noexcept { ++m_strongCount; }
+
+    void release() noexcept
+    {
+        if (--m_strongCount == 0) {
+            destroyObject();
+            releaseWeak();
+        }
+    }
+
+    bool tryRetain() noexcept
+    {
+        if (m_strongCount == 0) {
+            return false;
+        }
+        ++m_strongCount;
+        return true;
+    }
+
+    void retainWeak() noexcept { ++m_weakCount; }
+
+    void releaseWeak() noexcept
+    {
+        if (--m_weakCount == 0) {
+            destroyBlock();
+        }
+    }
+
+    uint32_t useCount() const noexcept { return m_strongCount; }
+
+private:
+    virtual void destroyObject() noexcept = 0;
+    virtual void destroyBlock() noexcept = 0;
+
+    uint32_t m_strongCount = 1;
+    uint32_t m_weakCount = 1;
+};
+
+// Stores the object in the same allocation as its reference counts, like std::allocate_shared.
+template<typename T>
+class LocalSharedBlock final : public LocalControlBlock
+{
+public:
+    explicit LocalSharedBlock(pmr::memory_resource *resource) noexcept
+        : m_resource(resource)
+    {
+    }
+
+    template<typename... Args>
+    T *construct(Args &&...args)
+    {
+        return ::new (static_cast<void *>(m_storage)) T(std::forward<Args>(args)...);
+    }
+
+private:
+    void destroyObject() noexcept override
+    {
+        std::launder(reinterpret_cast<T *>(m_storage))->~T();
+    }
+
+    void destroyBlock() noexcept override
+    {
+        auto *resource = m_resource;
+        this->~LocalSharedBlock();
+        resource->deallocate(this, sizeof(LocalSharedBlock), alignof(LocalSharedBlock));
+    }
+
+    pmr::memory_resource *m_resource;
+    alignas(T) unsigned char m_storage[sizeof(T)];
+};
+
+class LocalSharedFromThisBase
+{
+protected:
+    LocalSharedFromThisBase() noexcept = default;
+    // Like std::enable_shared_from_this, a copy of an object is a different object,
+    // so it does not share the reference counts of the original.
+    LocalSharedFromThisBase(const LocalSharedFromThisBase &) noexcept { }
+    LocalSharedFromThisBase &operator=(const LocalSharedFromThisBase &) noexcept { return *this; }
+    ~LocalSharedFromThisBase() = default;
+
+    LocalControlBlock *m_controlBlock = nullptr;
+
+    template<typename T, typename... Args>
+    friend LocalSharedPtr<T> allocateLocalShared(pmr::memory_resource *resource, Args &&...args);
+};
+
+/**
+ * The equivalent of std::enable_shared_from_this for objects created with allocateLocalShared.
+ */
+template<typename T>
+class EnableLocalSharedFromThis : public LocalSharedFromThisBase
+{
+public:
+    LocalSharedPtr<T> shared_from_this()
+    {
+        if (!m_controlBlock || !m_controlBlock->tryRetain()) {
+            throw std::bad_weak_ptr();
+        }
+        return LocalSharedPtr<T>(static_cast<T *>(this), m_controlBlock);
+    }
+
+    LocalWeakPtr<T> weak_from_this() const noexcept
+    {
+        if (!m_controlBlock) {
+            return {};
+        }
+        m_controlBlock->retainWeak();
+        return LocalWeakPtr<T>(const_cast<T *>(static_cast<const T *>(this)), m_controlBlock);
+    }
+};
+
+/**
+ * A std::shared_ptr with non-atomic reference counting.
+ *
+ * Only the parts of the std::shared_ptr API that KDBindings needs are provided.
+ * Objects must be created with allocateLocalShared or makeLocalShared.
+ */
+template<typename T>
+class LocalSharedPtr
+{
+public:
+    constexpr LocalSharedPtr() noexcept = default;
+    constexpr LocalSharedPtr(std::nullptr_t) noexcept { }
+
+    LocalSharedPtr(const LocalSharedPtr &other) noexcept
+        : m_ptr(other.m_ptr), m_controlBlock(other.m_controlBlock)
+    {
+        if (m_controlBlock) {
+            m_controlBlock->retain();
+        }
+    }
+
+    template<typename U, typename = std::enable_if_t<std::is_convertible_v<U *, T *>>>
+    LocalSharedPtr(const LocalSharedPtr<U> &other) noexcept
+        : m_ptr(other.m_ptr), m_controlBlock(other.m_controlBlock)
+    {
+        if (m_controlBlock) {
+            m_controlBlock->retain();
+        }
+    }
+
+    LocalSharedPtr(LocalSharedPtr &&other) noexcept
+        : m_ptr(std::exchange(other.m_ptr, nullptr)), m_controlBlock(std::exchange(other.m_controlBlock, nullptr))
+    {
+    }
+
+    template<typename U, typename = std::enable_if_t<std::is_convertible_v<U *, T *>>>
+    LocalSharedPtr(LocalSharedPtr<U> &&other) noexcept
+        : m_ptr(std::exchange(other.m_ptr, nullptr)), m_controlBlock(std::exchange(other.m_controlBlock, nullptr))
+    {
+    }
+
+    LocalSharedPtr &operator=(const LocalSharedPtr &other) noexcept
+    {
+        LocalSharedPtr(other).swap(*this);
+        return *this;
+    }
+
+    LocalSharedPtr &operator=(LocalSharedPtr &&other) noexcept
+    {
+        LocalSharedPtr(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~LocalSharedPtr()
+    {
+        if (m_controlBlock) {
+            m_controlBlock->release();
+        }
+    }
+
+    void reset() noexcept { LocalSharedPtr().swap(*this); }
+
+    void swap(LocalSharedPtr &other) noexcept
+    {
+        std::swap(m_ptr, other.m_ptr);
+        std::swap(m_controlBlock, other.m_controlBlock);
+    }
+
+    T *get() const noexcept { return m_ptr; }
+    T &operator*() const noexcept { return *m_ptr; }
+    T *operator->() const noexcept { return m_ptr; }
+    explicit operator bool() const noexcept { return m_ptr != nullptr; }
+
+    long use_count() const noexcept { return m_controlBlock ? static_cast<long>(m_controlBlock->useCount()) : 0; }
+
+private:
+    template<typename>
+    friend class LocalSharedPtr;
+    template<typename>
+    friend class LocalWeakPtr;
+    template<typename>
+    friend class EnableLocalSharedFromThis;
+    template<typename U, typename... Args>
+    friend LocalSharedPtr<U> allocateLocalShared(pmr::memory_resource *resource, Args &&...args);
+
+    // Adopts a strong reference that has already been counted.
+    LocalSharedPtr(T *ptr, LocalControlBlock *controlBlock) noexcept
+        : m_ptr(ptr), m_controlBlock(controlBlock)
+    {
+    }
+
+    T *m_ptr = nullptr;
+    LocalControlBlock *m_controlBlock = nullptr;
+};
+
+/**
+ * A std::weak_ptr with non-atomic reference counting, see LocalSharedPtr.
+ */
+template<typename T>
+class LocalWeakPtr
+{
+public:
+    constexpr LocalWeakPtr() noexcept = default;
+
+    LocalWeakPtr(const LocalWeakPtr &other) noexcept
+        : m_ptr(other.m_ptr), m_controlBlock(other.m_controlBlock)
+    {
+        if (m_controlBlock) {
+            m_controlBlock->retainWeak();
+        }
+    }
+
+    template<typename U, typename = std::enable_if_t<std::is_convertible_v<U *, T *>>>
+    LocalWeakPtr(const LocalWeakPtr<U> &other) noexcept
+        : m_ptr(other.m_ptr), m_controlBlock(other.m_controlBlock)
+    {
+        if (m_controlBlock) {
+            m_controlBlock->retainWeak();
+        }
+    }
+
+    template<typename U, typename = std::enable_if_t<std::is_convertible_v<U *, T *>>>
+    LocalWeakPtr(const LocalSharedPtr<U> &other) noexcept
+        : m_ptr(other.m_ptr), m_controlBlock(other.m_controlBlock)
+    {
+        if (m_controlBlock) {
+            m_controlBlock->retainWeak();
+        }
+    }
+
+    LocalWeakPtr(LocalWeakPtr &&other) noexcept
+        : m_ptr(std::exchange(other.m_ptr, nullptr)), m_controlBlock(std::exchange(other.m_controlBlock, nullptr))
+    {
+    }
+
+    template<typename U, typename = std::enable_if_t<std::is_convertible_v<U *, T *>>>
+    LocalWeakPtr(LocalWeakPtr<U> &&other) noexcept
+        : m_ptr(std::exchange(other.m_ptr, nullptr)), m_controlBlock(std::exchange(other.m_controlBlock, nullptr))
+    {
+    }
+
+    LocalWeakPtr &operator=(const LocalWeakPtr &other) noexcept
+    {
+        LocalWeakPtr(other).swap(*this);
+        return *this;
+    }
+
+    LocalWeakPtr &operator=(LocalWeakPtr &&other) noexcept
+    {
+        LocalWeakPtr(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~LocalWeakPtr()
+    {
+        if (m_controlBlock) {
+            m_controlBlock->releaseWeak();
+        }
+    }
+
+    void reset() noexcept { LocalWeakPtr().swap(*this); }
+
+    void swap(LocalWeakPtr &other) noexcept
+    {
+        std::swap(m_ptr, other.m_ptr);
+        std::swap(m_controlBlock, other.m_controlBlock);
+    }
+
+    bool expired() const noexcept { return use_count() == 0; }
+
+    long use_count() const noexcept { return m_controlBlock ? static_cast<long>(m_controlBlock->useCount()) : 0; }
+
+    LocalSharedPtr<T> lock() const noexcept
+    {
+        if (m_controlBlock && m_controlBlock->tryRetain()) {
+            return LocalSharedPtr<T>(m_ptr, m_controlBlock);
+        }
+        return {};
+    }
+
+private:
+    template<typename>
+    friend class LocalWeakPtr;
+    template<typename>
+    friend class EnableLocalSharedFromThis;
+
+    // Adopts a weak reference that has already been counted.
+    LocalWeakPtr(T *ptr, LocalControlBlock *controlBlock) noexcept
+        : m_ptr(ptr), m_controlBlock(controlBlock)
+    {
+    }
+
+    T *m_ptr = nullptr;
+    LocalControlBlock *m_controlBlock = nullptr;
+};
+
+/**
+ * The equivalent of std::allocate_shared for LocalSharedPtr.
+ *
+ * The object and its reference counts are allocated together from the given memory resource.
+ */
+template<typename T, typename... Args>
+LocalSharedPtr<T> allocateLocalShared(pmr::memory_resource *resource, Args &&...args)
+{
+    using Block = LocalSharedBlock<T>;
+    auto *block = ::new (resource->allocate(sizeof(Block), alignof(Block))) Block(resource);
+    T *object = nullptr;
+    try {
+        object = block->construct(std::forward<Args>(args)...);
+    } catch (...) {
+        block->~Block();
+        resource->deallocate(block, sizeof(Block), alignof(Block));
+        throw;
+    }
+    if constexpr (std::is_convertible_v<T *, LocalSharedFromThisBase *>) {
+        static_cast<LocalSharedFromThisBase *>(object)->m_controlBlock = block;
+    }
+    return LocalSharedPtr<T>(object, block);
+}
+
+/**
+ * The equivalent of std::make_shared for LocalSharedPtr.
+ */
+template<typename T, typename... Args>
+LocalSharedPtr<T> makeLocalShared(Args &&...args)
+{
+    return allocateLocalShared<T>(pmr::new_delete_resource(), std::forward<Args>(args)...);
+}
+
+// The shared ownership that Signal, ConnectionHandle and BindingEvaluator use internally.
+//
+// By default this is std::shared_ptr, which can be used from any thread.
+// If KDBINDINGS_SINGLE_THREADED is defined (see the KDBindings_SINGLE_THREADED CMake option),
+// the non-atomic LocalSharedPtr is used instead, which makes copying ConnectionHandles
+// and checking them cheaper, but means Signals, ConnectionHandles and BindingEvaluators
+// must not be used from multiple threads at the same time.
+#ifdef KDBINDINGS_SINGLE_THREADED
+template<typename T>
+using SharedPtr = LocalSharedPtr<T>;
+template<typename T>
+using WeakPtr = LocalWeakPtr<T>;
+template<typename T>
+using EnableSharedFromThis = EnableLocalSharedFromThis<T>;
+
+template<typename T, typename... Args>
+SharedPtr<T> allocateShared(pmr::memory_resource *resource, Args &&...args)
+{
+    return allocateLocalShared<T>(resource, std::forward<Args>(args)...);
+}
+#else
+template<typename T>
+using SharedPtr = std::shared_ptr<T>;
+template<typename T>
+using WeakPtr = std::weak_ptr<T>;
+template<typename T>
+using EnableSharedFromThis = std::enable_shared_from_this<T>;
+
+template<typename T, typename... Args>
+SharedPtr<T> allocateShared(pmr::memory_resource *resource, Args &&...args)
+{
+    return std::allocate_shared<T>(ResourceAllocator<T>(resource), std::forward<Args>(args)...);
+}
+#endif
+
+} // namespace Private
+
+} // namespace KDBindings
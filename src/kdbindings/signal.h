@@ -11,12 +11,19 @@
 
 #pragma once
 
+#include <algorithm>
 #include <assert.h>
+#include <cstdint>
 #include <memory>
 #include <stdexcept>
+#include <string_view>
 #include <type_traits>
 #include <utility>
 #include <forward_list>
+#include <cstddef>
+#include <functional>
+#include <tuple>
+#include <vector>
 
 #ifdef emit
 static_assert(false, "KDBindings is not compatible with Qt's 'emit' keyword.\n"
@@ -29,7 +36,13 @@ static_assert(false, "KDBindings is not compatible with Qt's 'emit' keyword.\n"
 #endif
 
 #include <kdbindings/connection_evaluator.h>
+#include <kdbindings/connection_handle.h>
 #include <kdbindings/genindex_array.h>
+#include <kdbindings/memory_resource.h>
+#include <kdbindings/metrics_recorder.h>
+#include <kdbindings/shared_ptr.h>
+#include <kdbindings/small_function.h>
+#include <kdbindings/tracing.h>
 #include <kdbindings/utils.h>
 
 #include <kdbindings/KDBindingsConfig.h>
@@ -40,6 +53,49 @@ static_assert(false, "KDBindings is not compatible with Qt's 'emit' keyword.\n"
  * All public parts of KDBindings are members of this namespace.
  */
 namespace KDBindings {
+
+/**
+ * @brief A SignalBatch is a non-owning view of contiguous argument tuples, which are emitted
+ * together by Signal::emitBatch.
+ *
+ * It provides a subset of the interface of C++20's std::span.
+ * It can be constructed from a pointer and a size, or implicitly from any contiguous container of
+ * `std::tuple<Args...>` that provides `data()` and `size()`, like a std::vector or std::array.
+ */
+template<typename... Args>
+class SignalBatch
+{
+public:
+    using value_type = std::tuple<Args...>;
+
+    SignalBatch() noexcept = default;
+
+    SignalBatch(const value_type *data, std::size_t size) noexcept
+        : m_data(data), m_size(size)
+    {
+    }
+
+    template<typename Container,
+             typename = std::enable_if_t<std::is_convertible_v<decltype(std::declval<const Container &>().data()), const value_type *>>>
+    SignalBatch(const Container &container) noexcept
+        : m_data(container.data()), m_size(container.size())
+    {
+    }
+
+    const value_type *data() const noexcept { return m_data; }
+    std::size_t size() const noexcept { return m_size; }
+    bool empty() const noexcept { return m_size == 0; }
+
+    const value_type *begin() const noexcept { return m_data; }
+    const value_type *end() const noexcept { return m_data + m_size; }
+
+    const value_type &operator[](std::size_t index) const noexcept { return m_data[index]; }
+
+private:
+    const value_type *m_data = nullptr;
+    std::size_t m_size = 0;
+};
+
 /**
  * @brief A Signal provides a mechanism for communication between objects.
  *
@@ -80,7 +136,16 @@ class Signal
     class Impl : public Private::SignalImplBase
     {
     public:
-        Impl() noexcept { }
+        explicit Impl(pmr::memory_resource *resource, bool hasExplicitResource = false) noexcept
+            : m_connections(resource)
+            , m_deferredConnections(resource)
+            , m_batchSlots(resource)
+            , m_connectedDuringEmit(resource)
+            , m_resource(resource)
+            , m_hasExplicitResource(hasExplicitResource)
+            , m_disconnectedDuringEmit(resource)
+        {
+        }
 
         ~Impl() noexcept { }
 
@@ -92,46 +157,94 @@ class Signal
         Impl(Impl &&other) = delete;
         Impl &operator=(Impl &&other) = delete;
 
-        // Connects a std::function to the signal. The returned
+        // Connects a callable to the signal. The returned
         // value can be used to disconnect the function again.
-        Private::GenerationalIndex connect(std::function<void(Args...)> const &slot)
+        //
+        // The callable is stored directly inside the Connection if it is small enough,
+        // so no type erasure through std::function and no allocation is needed.
+        // Otherwise it is allocated from the memory resource of the Signal.
+        template<typename Func>
+        Private::GenerationalIndex connect(Func &&slot)
         {
             Connection newConnection;
-            newConnection.slot = slot;
-            return m_connections.insert(std::move(newConnection));
+            if (!Private::isNullCallable(slot)) {
+                newConnection.slot = Slot(std::allocator_arg, m_resource, [slot = std::forward<Func>(slot)](ConnectionHandle *, const Args &...args) mutable {
+                    std::invoke(slot, args...);
+                });
+            }
+            return insertConnection(std::move(newConnection));
         }
 
         // Establish a deferred connection between signal and slot, where ConnectionEvaluator object
         // is used to queue all the connection to evaluate later. The returned
         // value can be used to disconnect the slot later.
-        Private::GenerationalIndex connectDeferred(const std::shared_ptr<ConnectionEvaluator> &evaluator, std::function<void(Args...)> const &slot)
+        Private::GenerationalIndex connectDeferred(const std::shared_ptr<ConnectionEvaluator> &evaluator, std::function<void(Args...)> const &slot,
+                                                   DeferredConnectionMode mode, DeferredConnectionPriority priority)
         {
-            auto weakEvaluator = std::weak_ptr<ConnectionEvaluator>(evaluator);
-
-            auto deferredSlot = [weakEvaluator = std::move(weakEvaluator), slot](ConnectionHandle &handle, Args... args) {
-                if (auto evaluatorPtr = weakEvaluator.lock()) {
-                    auto lambda = [slot, args...]() {
-                        slot(args...);
+            // The slot is shared by all queued invocations, so queueing an invocation doesn't need to copy it.
+            auto sharedSlot = Private::allocateShared<const std::function<void(Args...)>>(m_resource, slot);
+
+            auto deferredSlot = [this, sharedSlot = std::move(sharedSlot)](ConnectionHandle &handle, const Args &...args) {
+                const auto &deferredConnection = m_deferredConnections[handle.m_id->index];
+                const auto evaluatorId = deferredConnection.evaluatorId;
+                const auto mode = deferredConnection.mode;
+                if (auto evaluatorPtr = deferredConnection.evaluator.lock()) {
+                    // The arguments need to be copied here, as the slot is only invoked after emit returns.
+                    // Small arguments are stored inline in the queue of the ConnectionEvaluator.
+                    auto lambda = [sharedSlot, args...]() {
+                        (*sharedSlot)(args...);
                     };
-                    evaluatorPtr->enqueueSlotInvocation(handle, lambda);
+                    evaluatorPtr->enqueueSlotInvocation(evaluatorId, mode, Private::traceDeferred(std::move(lambda)));
                 } else {
                     throw std::runtime_error("ConnectionEvaluator is no longer alive");
                 }
             };
 
-            Connection newConnection;
-            newConnection.m_connectionEvaluator = evaluator;
-            newConnection.slotReflective = deferredSlot;
-
-            return m_connections.insert(std::move(newConnection));
+            const auto id = connectReflective(std::move(deferredSlot));
+            try {
+                setConnectionEvaluator(id, evaluator, mode, priority);
+            } catch (...) {
+                disconnect(ConnectionHandle::borrowed(this, id));
+                throw;
+            }
+            return id;
         }
 
-        Private::GenerationalIndex connectReflective(std::function<void(ConnectionHandle &handle, Args...)> const &slot)
+        template<typename Func>
+        Private::GenerationalIndex connectReflective(Func &&slot)
         {
             Connection newConnection;
-            newConnection.slotReflective = slot;
+            if (!Private::isNullCallable(slot)) {
+                newConnection.reflective = true;
+                newConnection.slot = Slot(std::allocator_arg, m_resource, [slot = std::forward<Func>(slot)](ConnectionHandle *handle, const Args &...args) mutable {
+                    std::invoke(slot, *handle, args...);
+                });
+            }
+            return insertConnection(std::move(newConnection));
+        }
 
-            return m_connections.insert(std::move(newConnection));
+        // Connects a callable that receives all values of an emitBatch at once.
+        template<typename Func>
+        Private::GenerationalIndex connectBatch(Func &&slot)
+        {
+            static_assert(std::is_copy_constructible_v<std::tuple<Args...>>,
+                          "Batch connections require copyable Signal parameters, as emit() passes a copy of its arguments to them!");
+
+            auto batchSlot = Private::allocateUnique<BatchSlot>(m_resource, std::allocator_arg, m_resource, std::forward<Func>(slot));
+
+            Connection newConnection;
+            newConnection.batch = true;
+            const auto id = insertConnection(std::move(newConnection));
+            try {
+                if (m_batchSlots.size() <= id.index) {
+                    m_batchSlots.resize(id.index + 1);
+                }
+            } catch (...) {
+                disconnect(ConnectionHandle::borrowed(this, id));
+                throw;
+            }
+            m_batchSlots[id.index] = std::move(batchSlot);
+            return id;
         }
 
         // Disconnects a previously connected function
@@ -149,19 +262,23 @@ class Signal
                 auto id = idOpt.value();
 
                 // Retrieve the connection associated with this id
-                auto connection = m_connections.get(id);
-                if (connection && m_isEmitting) {
+                auto connection = findConnection(id);
+                if (connection && m_emitDepth > 0) {
                     // We are currently still emitting the signal, so we need to defer the actual
                     // disconnect until the emit is done.
-                    connection->toBeDisconnected = true;
-                    m_disconnectedDuringEmit = true;
+                    deferDisconnect(id, *connection);
                     return;
                 }
 
-                if (connection && connection->m_connectionEvaluator.lock()) {
-                    if (auto evaluatorPtr = connection->m_connectionEvaluator.lock()) {
-                        evaluatorPtr->dequeueSlotInvocation(handle);
+                if (connection && id.index < m_deferredConnections.size()) {
+                    auto &deferredConnection = m_deferredConnections[id.index];
+                    if (auto evaluatorPtr = deferredConnection.evaluator.lock()) {
+                        evaluatorPtr->dequeueSlotInvocation(deferredConnection.evaluatorId);
                     }
+                    deferredConnection.evaluator.reset();
+                }
+                if (connection && connection->batch) {
+                    m_batchSlots[id.index].reset();
                 }
 
                 // Note: This function may throw if we're out of memory.
@@ -176,20 +293,47 @@ class Signal
         // if it is not possible to allocate memory or if mutex locking isn't possible.
         void disconnectAll() noexcept
         {
-            const auto numEntries = m_connections.entriesSize();
+            if (m_emitDepth > 0) {
+                // All connections, including the ones made during the current emit,
+                // are disconnected once the emit is done.
+                for (auto i = decltype(m_connections.size()){ 0 }; i < m_connections.size(); ++i) {
+                    deferDisconnect(m_connections.indexAt(i), m_connections.valueAt(i));
+                }
+                for (auto &pending : m_connectedDuringEmit) {
+                    deferDisconnect(pending.first, pending.second);
+                }
+                return;
+            }
 
-            const auto sharedThis = shared_from_this();
-            for (auto i = decltype(numEntries){ 0 }; i < numEntries; ++i) {
-                const auto indexOpt = m_connections.indexAtEntry(i);
-                if (sharedThis && indexOpt) {
-                    disconnect(ConnectionHandle(sharedThis, *indexOpt));
+            // Removing the queued invocations of a deferred connection doesn't depend on the number of
+            // queued invocations, so this only needs to visit the live connections once.
+            for (auto i = decltype(m_connections.size()){ 0 }; i < m_connections.size(); ++i) {
+                const auto index = m_connections.indexAt(i).index;
+                if (!m_connections.valueAt(i).reflective || index >= m_deferredConnections.size()) {
+                    continue;
+                }
+                const auto &deferredConnection = m_deferredConnections[index];
+                if (auto evaluator = deferredConnection.evaluator.lock()) {
+                    evaluator->dequeueSlotInvocation(deferredConnection.evaluatorId);
                 }
             }
+            m_deferredConnections.clear();
+
+            // Note: This may throw if we're out of memory.
+            // As `disconnectAll` is marked as `noexcept`, this will terminate the program.
+            m_connections.clear();
+
+            // The batch slots are destroyed outside of m_batchSlots, in case their destructors connect new batch slots.
+            auto batchSlots = std::move(m_batchSlots);
+            batchSlots.clear();
+            if (m_batchSlots.empty()) {
+                m_batchSlots = std::move(batchSlots);
+            }
         }
 
         bool blockConnection(const Private::GenerationalIndex &id, bool blocked) override
         {
-            Connection *connection = m_connections.get(id);
+            Connection *connection = findConnection(id);
             if (connection) {
                 const bool wasBlocked = connection->blocked;
                 connection->blocked = blocked;
@@ -201,12 +345,13 @@ class Signal
 
         bool isConnectionActive(const Private::GenerationalIndex &id) const noexcept override
         {
-            return m_connections.get(id);
+            auto connection = findConnection(id);
+            return connection && !connection->toBeDisconnected;
         }
 
         bool isConnectionBlocked(const Private::GenerationalIndex &id) const override
         {
-            auto connection = m_connections.get(id);
+            auto connection = findConnection(id);
             if (connection) {
                 return connection->blocked;
             } else {
@@ -214,51 +359,96 @@ class Signal
             }
         }
 
-        void emit(Args... p)
+        bool isEmitting() const noexcept
         {
-            if (m_isEmitting) {
-                throw std::runtime_error("Signal is already emitting, nested emits are not supported!");
-            }
-            m_isEmitting = true;
-
-            const auto numEntries = m_connections.entriesSize();
-
-            // This loop can *not* tolerate new connections being added to the signal inside a slot
-            // Doing so will be undefined behavior
-            for (auto i = decltype(numEntries){ 0 }; i < numEntries; ++i) {
-                const auto index = m_connections.indexAtEntry(i);
-
-                if (index) {
-                    const auto con = m_connections.get(*index);
-
-                    if (!con->blocked) {
-                        if (con->slotReflective) {
-                            if (auto sharedThis = shared_from_this(); sharedThis) {
-                                ConnectionHandle handle(sharedThis, *index);
-                                con->slotReflective(handle, p...);
-                            }
-                        } else if (con->slot) {
-                            con->slot(p...);
-                        }
+            return m_emitDepth > 0;
+        }
+
+        // Without KDBINDINGS_ENABLE_METRICS, the recorder has no state, so it isn't stored in every Impl.
+        Private::SignalMetricsRecorder &metricsRecorder() noexcept
+        {
+#ifdef KDBINDINGS_ENABLE_METRICS
+            return m_metrics;
+#else
+            static Private::SignalMetricsRecorder recorder;
+            return recorder;
+#endif
+        }
+
+        void emit(const Args &...p)
+        {
+            EmitGuard guard(*this);
+            Private::TraceScope trace("signal", "Signal::emit", this);
+            auto metrics = metricsRecorder().recordEmit();
+
+            // Connections made by a slot are only added to m_connections once the outermost emit is done,
+            // and disconnections are deferred until then as well.
+            // So the connections never move while a slot is running.
+            const auto numConnections = m_connections.size();
+
+            for (auto i = decltype(numConnections){ 0 }; i < numConnections; ++i) {
+                const auto &con = m_connections.valueAt(i);
+
+                // Only the flags at the start of the Connection are needed to skip it.
+                if (con.blocked || con.toBeDisconnected) {
+                    if (con.blocked) {
+                        metrics.blockedSkip();
+                    }
+                    continue;
+                }
+
+                metrics.connectionInvoked();
+                if (con.reflective) {
+                    // The Signal is alive during the call, so the slot can use a borrowed handle,
+                    // which doesn't need any reference counting.
+                    ConnectionHandle handle = ConnectionHandle::borrowed(this, m_connections.indexAt(i));
+                    invokeSlot(metrics, [&] { con.slot(&handle, p...); });
+                } else if (con.slot) {
+                    invokeSlot(metrics, [&] { con.slot(nullptr, p...); });
+                } else if (con.batch) {
+                    if constexpr (std::is_copy_constructible_v<std::tuple<Args...>>) {
+                        // A batch slot receives the values of a single emit as a batch of one.
+                        const std::tuple<Args...> values(p...);
+                        invokeSlot(metrics, [&] { (*m_batchSlots[m_connections.indexAt(i).index])(SignalBatch<Args...>(&values, 1)); });
                     }
                 }
             }
-            m_isEmitting = false;
+        }
 
-            if (m_disconnectedDuringEmit) {
-                m_disconnectedDuringEmit = false;
+        // Instead of emitting every element of the batch on its own, call each slot for all elements,
+        // so that each connection is only looked up once.
+        void emitBatch(const SignalBatch<Args...> &batch)
+        {
+            EmitGuard guard(*this);
+            Private::TraceScope trace("signal", "Signal::emitBatch", this);
+            auto metrics = metricsRecorder().recordEmit(batch.size());
+
+            const auto numConnections = m_connections.size();
+
+            for (auto i = decltype(numConnections){ 0 }; i < numConnections; ++i) {
+                const auto &con = m_connections.valueAt(i);
 
-                // Because m_connections is using a GenerationIndexArray, this loop can tolerate
-                // deletions inside the loop. So iterating over the array and deleting entries from it
-                // should not lead to undefined behavior.
-                for (auto i = decltype(numEntries){ 0 }; i < numEntries; ++i) {
-                    const auto index = m_connections.indexAtEntry(i);
+                if (con.blocked || con.toBeDisconnected) {
+                    if (con.blocked) {
+                        metrics.blockedSkip();
+                    }
+                    continue;
+                }
 
-                    if (index.has_value()) {
-                        const auto con = m_connections.get(index.value());
-                        if (con->toBeDisconnected) {
-                            disconnect(ConnectionHandle(shared_from_this(), index));
+                metrics.connectionInvoked();
+                if (con.batch) {
+                    invokeSlot(metrics, [&] { (*m_batchSlots[m_connections.indexAt(i).index])(batch); });
+                } else if (con.slot) {
+                    ConnectionHandle handle = con.reflective ? ConnectionHandle::borrowed(this, m_connections.indexAt(i)) : ConnectionHandle();
+                    ConnectionHandle *handlePtr = con.reflective ? &handle : nullptr;
+
+                    for (const auto &values : batch) {
+                        // A slot may block or disconnect itself, in which case it
+                        // must not receive the remaining values.
+                        if (con.blocked || con.toBeDisconnected) {
+                            break;
                         }
+                        invokeSlot(metrics, [&] { std::apply([&con, handlePtr](const auto &...p) { con.slot(handlePtr, p...); }, values); });
                     }
                 }
             }
@@ -266,37 +456,222 @@ class Signal
 
     private:
         friend class Signal;
+
+        // Calls a slot, so that it is recorded by the metrics and the Tracer.
+        template<typename Func>
+        void invokeSlot(Private::SignalMetricsRecorder::EmitRecord &metrics, Func &&slotCall)
+        {
+            metrics.invoke([&] {
+                Private::TraceScope trace("signal", "slot", this);
+                slotCall();
+            });
+        }
+
+        // Slots receive the emitted values by const reference, so that emitting does not need to
+        // copy the arguments for every slot.
+        // Note that for reference types, `const Args &` is just `Args`, so e.g. a Signal<int &>
+        // still passes a mutable reference to its slots.
+        //
+        // Normal and reflective slots share the same Slot type, so emitting only needs a single
+        // indirect call per connection. The ConnectionHandle is only passed to reflective slots,
+        // normal slots receive a nullptr.
+        using Slot = Private::SmallFunction<void(ConnectionHandle *, const Args &...)>;
+
+        // A Connection only contains the data that is needed when emitting.
+        // The flags come first, so a connection that is skipped doesn't need to touch the slot itself.
+        // Data that is rarely needed, like the ConnectionEvaluator of a deferred connection,
+        // is stored separately (see m_deferredConnections).
         struct Connection {
-            std::function<void(Args...)> slot;
-            std::function<void(ConnectionHandle &, Args...)> slotReflective;
-            std::weak_ptr<ConnectionEvaluator> m_connectionEvaluator;
             bool blocked{ false };
             // When we disconnect while the signal is still emitting, we need to defer the actual disconnection
             // until the emit is done. This flag is set to true when the connection should be disconnected.
             bool toBeDisconnected{ false };
+            // Whether the slot expects a ConnectionHandle.
+            bool reflective{ false };
+            // Whether this is a batch connection, which stores its slot in m_batchSlots.
+            bool batch{ false };
+            Slot slot;
         };
 
-        mutable Private::GenerationalIndexArray<Connection> m_connections;
+        using BatchSlot = Private::SmallFunction<void(const SignalBatch<Args...> &)>;
+
+        // Counts the emits of this signal that are currently running, so that emits can be nested.
+        // Any changes to the connections are deferred until the outermost emit is done.
+        // The guard also makes sure that this happens if a slot throws.
+        class EmitGuard
+        {
+        public:
+            explicit EmitGuard(Impl &impl) noexcept
+                : m_impl(impl)
+            {
+                ++m_impl.m_emitDepth;
+            }
+
+            ~EmitGuard() noexcept
+            {
+                if (--m_impl.m_emitDepth == 0 && (!m_impl.m_disconnectedDuringEmit.empty() || !m_impl.m_connectedDuringEmit.empty())) {
+                    m_impl.finishEmit();
+                }
+            }
+
+            EmitGuard(const EmitGuard &) = delete;
+            EmitGuard &operator=(const EmitGuard &) = delete;
+
+        private:
+            Impl &m_impl;
+        };
+
+        // Marks a connection to be disconnected once the outermost emit is done.
+        void deferDisconnect(const Private::GenerationalIndex &id, Connection &connection) noexcept
+        {
+            if (!connection.toBeDisconnected) {
+                connection.toBeDisconnected = true;
+                // insertConnection reserves enough capacity for all connections, so this doesn't allocate.
+                m_disconnectedDuringEmit.push_back(id);
+            }
+        }
+
+        Private::GenerationalIndex insertConnection(Connection &&connection)
+        {
+            // Make sure that every connection fits into m_disconnectedDuringEmit,
+            // so disconnecting during an emit never needs to allocate.
+            const std::size_t connectionCount = m_disconnectedDuringEmit.size() + m_connections.size() + m_connectedDuringEmit.size() + 1;
+            if (m_disconnectedDuringEmit.capacity() < connectionCount) {
+                m_disconnectedDuringEmit.reserve((std::max)(connectionCount, 2 * m_disconnectedDuringEmit.capacity()));
+            }
+
+            if (m_emitDepth == 0) {
+                return m_connections.insert(std::move(connection));
+            }
+
+            // Only allocate the index of the new connection for now, the connection itself is
+            // added to m_connections when the outermost emit is done.
+            m_connectedDuringEmit.emplace_back(Private::GenerationalIndex{}, std::move(connection));
+            auto &pending = m_connectedDuringEmit.back();
+            try {
+                pending.first = m_connections.allocateIndex();
+            } catch (...) {
+                m_connectedDuringEmit.pop_back();
+                throw;
+            }
+            return pending.first;
+        }
+
+        // Finds a connection, including the ones that were made during the current emit.
+        Connection *findConnection(const Private::GenerationalIndex &id) noexcept
+        {
+            if (auto connection = m_connections.get(id)) {
+                return connection;
+            }
+            for (auto &pending : m_connectedDuringEmit) {
+                if (pending.first == id) {
+                    return &pending.second;
+                }
+            }
+            return nullptr;
+        }
+
+        const Connection *findConnection(const Private::GenerationalIndex &id) const noexcept
+        {
+            return const_cast<Impl *>(this)->findConnection(id);
+        }
+
+        // Applies all changes to the connections that were made during the emit.
+        //
+        // WARNING: While this function is marked with noexcept, it *may* terminate the program
+        // if it is not possible to allocate memory.
+        void finishEmit() noexcept
+        {
+            for (auto &pending : m_connectedDuringEmit) {
+                m_connections.set(pending.first, std::move(pending.second));
+            }
+            m_connectedDuringEmit.clear();
+
+            // Only visit the connections that were disconnected during the emit.
+            // The list may grow while it is processed, as the destructor of a slot may disconnect other slots,
+            // so it is not iterated with iterators.
+            // Erasing a connection moves the connections behind it, so the list is processed from its end.
+            // Connections are usually disconnected in the order in which they are stored, e.g. by disconnectAll,
+            // so this mostly erases the last connection, which doesn't move any others.
+            while (!m_disconnectedDuringEmit.empty()) {
+                const auto id = m_disconnectedDuringEmit.back();
+                m_disconnectedDuringEmit.pop_back();
+                disconnect(ConnectionHandle::borrowed(this, id));
+            }
+        }
+
+        void setConnectionEvaluator(const Private::GenerationalIndex &id, const std::shared_ptr<ConnectionEvaluator> &evaluator,
+                                    DeferredConnectionMode mode, DeferredConnectionPriority priority)
+        {
+            if (m_deferredConnections.size() <= id.index) {
+                m_deferredConnections.resize(id.index + 1);
+            }
+            m_deferredConnections[id.index] = { evaluator, evaluator->registerConnection(mode, priority), mode };
+        }
+
+        // The connections are kept densely packed and in the order in which they were made,
+        // so emitting only visits live connections and calls them in order.
+        mutable Private::DenseGenerationalIndexArray<Connection> m_connections;
+        // A deferred connection is registered with its ConnectionEvaluator under its own index,
+        // which identifies its queued invocations.
+        struct DeferredConnection {
+            std::weak_ptr<ConnectionEvaluator> evaluator;
+            Private::GenerationalIndex evaluatorId;
+            DeferredConnectionMode mode = DeferredConnectionMode::Queued;
+        };
+        // The ConnectionEvaluators of deferred connections, indexed by the index of the connection.
+        // These are rarely needed when emitting, so they're kept out of m_connections.
+        Private::Vector<DeferredConnection> m_deferredConnections;
+        // The slots of batch connections, indexed by the index of the connection.
+        // They're allocated separately, so they don't move when this vector grows during an emit.
+        Private::Vector<Private::ResourceUniquePtr<BatchSlot>> m_batchSlots;
+        // Connections that were made while the signal was emitting.
+        Private::Vector<std::pair<Private::GenerationalIndex, Connection>> m_connectedDuringEmit;
+
+        // All memory of the Impl is allocated from this memory resource.
+        pmr::memory_resource *m_resource;
+        // Whether the memory resource was given to the Signal explicitly.
+        // In that case the Impl is kept alive when all slots are disconnected,
+        // so that later connections are allocated from the same memory resource.
+        bool m_hasExplicitResource;
 
         // If a reflective slot disconnects itself, we need to make sure to not deconstruct the std::function
         // while it is still running.
         // Therefore, defer all slot disconnections until the emit is done.
         //
-        // Previously, we stored the ConnectionHandles that were to be disconnected in a list.
-        // However, that would mean that disconnecting cannot be noexcept, as it may need to allocate memory in that list.
-        // We can fix this by storing this information within each connection itself (the toBeDisconnected flag).
-        // Because of the memory layout of the `struct Connection`, this shouldn't even use any more memory.
-        //
-        // The only downside is that we need to iterate over all connections to find the ones that need to be disconnected.
-        // This is helped by using the m_disconnedDuringEmit flag to avoid unnecessary iterations.
-        bool m_isEmitting = false;
-        bool m_disconnectedDuringEmit = false;
+        // A connection that is disconnected during an emit is marked with the toBeDisconnected flag,
+        // so that it is skipped right away, and its index is added to m_disconnectedDuringEmit,
+        // so that finishing the emit only needs to visit the connections that were actually disconnected.
+        // Disconnecting must be noexcept, so insertConnection reserves enough capacity in this list
+        // for all connections in advance.
+        uint32_t m_emitDepth = 0;
+        Private::Vector<Private::GenerationalIndex> m_disconnectedDuringEmit;
+
+#ifdef KDBINDINGS_ENABLE_METRICS
+        Private::SignalMetricsRecorder m_metrics;
+#endif
     };
 
 public:
     /** Signals are default constructible */
     Signal() = default;
 
+    /**
+     * Constructs a Signal that allocates all of its memory from the given memory resource.
+     *
+     * This includes the storage for its connections, as well as slots that are too large to be
+     * stored inside a connection.
+     * The memory resource must outlive the Signal and all ConnectionHandles of the Signal.
+     *
+     * A Signal that is constructed without a memory resource uses pmr::new_delete_resource().
+     * The global default resource (std::pmr::get_default_resource()) is never used, as a Signal
+     * may outlive any scope in which it was installed.
+     */
+    explicit Signal(pmr::memory_resource *resource)
+        : m_impl(Private::allocateShared<Impl>(resource, resource, true))
+    {
+    }
+
     /**
      * Signals cannot be copied.
      **/
@@ -348,18 +723,19 @@ public:
      * to include a reference to the ConnectionHandle as the first parameter, enabling the slot to interact with
      * its own connection state directly.
      *
-     * @param slot A std::function that takes a ConnectionHandle reference followed by the signal's parameter types.
+     * @param slot A callable (e.g. a lambda or std::function) that takes a ConnectionHandle reference followed by the signal's parameter types.
      * @return A ConnectionHandle to the newly established connection, allowing for advanced connection management.
      *
      * @warning Connecting functions to a signal that throw an exception when called is currently undefined behavior.
      * All connected functions should handle their own exceptions.
      * For backwards-compatibility, the slot function is not required to be noexcept.
      */
-    KDBINDINGS_WARN_UNUSED ConnectionHandle connectReflective(std::function<void(ConnectionHandle &, Args...)> const &slot)
+    template<typename Func, typename = std::enable_if_t<std::is_invocable_v<std::decay_t<Func> &, ConnectionHandle &, const Args &...>>>
+    KDBINDINGS_WARN_UNUSED ConnectionHandle connectReflective(Func &&slot)
     {
         ensureImpl();
 
-        return ConnectionHandle{ m_impl, m_impl->connectReflective(slot) };
+        return ConnectionHandle{ m_impl, m_impl->connectReflective(std::forward<Func>(slot)) };
     }
 
     /**
@@ -367,21 +743,44 @@ public:
      * disconnected and the slot will be called. Note that the slot will be disconnected before it is called. If the slot
      * triggers another signal emission of the same signal, the slot will not be called again.
      *
-     * @param slot A std::function that takes the signal's parameter types.
+     * @param slot A callable (e.g. a lambda or std::function) that takes the signal's parameter types.
      * @return An instance of ConnectionHandle, that can be used to disconnect.
      *
      * @warning Connecting functions to a signal that throw an exception when called is currently undefined behavior.
      * All connected functions should handle their own exceptions.
      * For backwards-compatibility, the slot function is not required to be noexcept.
      */
-    KDBINDINGS_WARN_UNUSED ConnectionHandle connectSingleShot(std::function<void(Args...)> const &slot)
+    template<typename Func, typename = std::enable_if_t<std::is_invocable_v<std::decay_t<Func> &, const Args &...>>>
+    KDBINDINGS_WARN_UNUSED ConnectionHandle connectSingleShot(Func &&slot)
     {
-        return connectReflective([slot](ConnectionHandle &handle, Args... args) {
+        return connectReflective([slot = std::forward<Func>(slot)](ConnectionHandle &handle, const Args &...args) mutable {
             handle.disconnect();
             slot(args...);
         });
     }
 
+    /**
+     * Connects a slot that receives all values of a batch at once.
+     *
+     * The slot is called with a SignalBatch<Args...>.
+     * When the Signal is emitted with emitBatch(), the slot is called only once with the whole batch.
+     * When the Signal is emitted with emit(), the emitted values are copied into a
+     * batch that contains only a single element.
+     *
+     * @return An instance of ConnectionHandle, that can be used to disconnect
+     * or temporarily block the connection.
+     *
+     * @warning Connecting functions to a signal that throw an exception when called is currently undefined behavior.
+     * All connected functions should handle their own exceptions.
+     */
+    template<typename Func, typename = std::enable_if_t<std::is_invocable_v<std::decay_t<Func> &, const SignalBatch<Args...> &>>>
+    KDBINDINGS_WARN_UNUSED ConnectionHandle connectBatch(Func &&slot)
+    {
+        ensureImpl();
+
+        return ConnectionHandle{ m_impl, m_impl->connectBatch(std::forward<Func>(slot)) };
+    }
+
     /**
      * @brief Establishes a deferred connection between the provided evaluator and slot.
      *
@@ -393,6 +792,12 @@ public:
      * First argument to the function is reference to a shared pointer to the ConnectionEvaluator responsible for determining
      * when the slot should be executed.
      *
+     * By default, every emit queues an invocation of the slot. With DeferredConnectionMode::Conflated,
+     * the connection queues at most one invocation at a time, which is called with the arguments of the latest emit.
+     *
+     * The invocations of connections with a higher DeferredConnectionPriority are evaluated before
+     * those of connections with a lower priority.
+     *
      * @return An instance of ConnectionHandle, that can be used to disconnect
      * or temporarily block the connection.
      *
@@ -404,15 +809,28 @@ public:
      * All connected functions should handle their own exceptions.
      * For backwards-compatibility, the slot function is not required to be noexcept.
      */
-    KDBINDINGS_WARN_UNUSED ConnectionHandle connectDeferred(const std::shared_ptr<ConnectionEvaluator> &evaluator, std::function<void(Args...)> const &slot)
+    KDBINDINGS_WARN_UNUSED ConnectionHandle connectDeferred(const std::shared_ptr<ConnectionEvaluator> &evaluator, std::function<void(Args...)> const &slot,
+                                                            DeferredConnectionMode mode = DeferredConnectionMode::Queued,
+                                                            DeferredConnectionPriority priority = DeferredConnectionPriority::Normal)
     {
         ensureImpl();
 
         ConnectionHandle handle(m_impl, {});
-        handle.setId(m_impl->connectDeferred(evaluator, slot));
+        handle.setId(m_impl->connectDeferred(evaluator, slot, mode, priority));
         return handle;
     }
 
+    /**
+     * Establishes a deferred connection whose invocations are evaluated with the given priority.
+     *
+     * @see connectDeferred(const std::shared_ptr<ConnectionEvaluator> &, std::function<void(Args...)> const &, DeferredConnectionMode, DeferredConnectionPriority)
+     */
+    KDBINDINGS_WARN_UNUSED ConnectionHandle connectDeferred(const std::shared_ptr<ConnectionEvaluator> &evaluator, std::function<void(Args...)> const &slot,
+                                                            DeferredConnectionPriority priority)
+    {
+        return connectDeferred(evaluator, slot, DeferredConnectionMode::Queued, priority);
+    }
+
     /**
      * A template overload of Signal::connect that makes it easier to connect arbitrary functions to this
      * Signal.
@@ -439,6 +857,11 @@ public:
      *
      * For more examples see the @ref 07-advanced-connections/main.cpp example.
      *
+     * In contrast to connecting a std::function, the callable is stored in the Signal as-is.
+     * Callables that are at most the size of four pointers (e.g. most lambdas or a member function
+     * bound to an object) are stored inline, so connecting them does not allocate any memory for the
+     * slot and emitting the Signal calls them without going through a std::function.
+     *
      * @return An instance of a Signal::ConnectionHandle that refers to this connection.
      *          Warning: When connecting a member function you must use the returned ConnectionHandle
      *          to disconnect when the object containing the slot goes out of scope!
@@ -448,14 +871,19 @@ public:
      * For backwards-compatibility, the slot function is not required to be noexcept.
      **/
     // The enable_if_t makes sure that this connect function specialization is only
-    // available if we provide a function that cannot be otherwise converted to a
-    // std::function<void(Args...)>, as it otherwise tries to take precedence
-    // over the normal connect function.
-    template<typename Func, typename... FuncArgs, typename = std::enable_if_t<std::disjunction_v<std::negation<std::is_convertible<Func, std::function<void(Args...)>>>, std::integral_constant<bool, sizeof...(FuncArgs) /*Also enable this function if we want to bind at least one argument*/>>>>
+    // available if we don't provide a std::function<void(Args...)> directly, as that
+    // is handled by the non-template connect function.
+    template<typename Func, typename... FuncArgs, typename = std::enable_if_t<std::disjunction_v<std::negation<std::is_same<std::decay_t<Func>, std::function<void(Args...)>>>, std::integral_constant<bool, sizeof...(FuncArgs) /*Also enable this function if we want to bind at least one argument*/>>>>
     KDBINDINGS_WARN_UNUSED ConnectionHandle connect(Func &&slot, FuncArgs &&...args)
     {
-        std::function<void(Args...)> bound = Private::bind_first(std::forward<Func>(slot), std::forward<FuncArgs>(args)...);
-        return connect(bound);
+        ensureImpl();
+
+        if constexpr (sizeof...(FuncArgs) == 0 && std::is_invocable_v<std::decay_t<Func> &, const Args &...>) {
+            // The callable can be called with the arguments of the Signal directly, no need to bind anything.
+            return ConnectionHandle{ m_impl, m_impl->connect(std::forward<Func>(slot)) };
+        } else {
+            return ConnectionHandle{ m_impl, m_impl->connect(Private::bind_first(std::forward<Func>(slot), std::forward<FuncArgs>(args)...)) };
+        }
     }
 
     /**
@@ -493,7 +921,11 @@ public:
             // Once all connections are disconnected, we can release ownership of the Impl.
             // This does not destroy the Signal itself, just the Impl object.
             // If another slot is connected, another Impl object will be constructed.
-            m_impl.reset();
+            // While the Signal is emitting, the Impl is still in use and must be kept alive.
+            // With metrics enabled, the Impl also holds the metrics of the Signal, which must not be lost.
+            if (!m_impl->isEmitting() && !m_impl->m_hasExplicitResource && !Private::MetricsEnabled) {
+                m_impl.reset();
+            }
         }
         // If m_impl is nullptr, we don't have any connections to disconnect
     }
@@ -551,21 +983,28 @@ public:
      * Emits the Signal, which causes all connected slots to be called,
      * as long as they are not blocked.
      *
-     * The arguments provided to emit will be passed to each slot by copy,
-     * therefore consider using (const) references as the Args to the Signal
-     * wherever possible.
+     * The arguments provided to emit are passed to each slot by const reference,
+     * so emitting does not copy them.
+     * Only slots that take their parameters by value will receive a copy.
+     * Deferred connections (see connectDeferred()) copy the arguments once per
+     * connection, as the slot is only called after emit() has returned.
+     * Small arguments are stored inline in the queue of the ConnectionEvaluator,
+     * so they don't need to be allocated.
      *
-     * Note: Slots may disconnect themselves during an emit, which will cause the
-     * connection to be disconnected after all slots have been called.
+     * The slots are called in the order in which they were connected.
      *
-     * ⚠️ *Note: Connecting a new slot to a signal while the signal is still
-     * in the emit function is undefined behavior.*
+     * Emits may be nested, i.e. a slot may emit the same Signal again.
+     * Slots may also connect and disconnect slots while the Signal is emitting:
+     * - A slot that is disconnected during an emit is no longer called, neither by the
+     *   remaining part of the current emit, nor by any nested emit.
+     *   It is destroyed once the outermost emit has returned, so a slot can safely disconnect itself.
+     * - A slot that is connected during an emit is not called until the outermost emit has returned.
+     *   Its ConnectionHandle can be used to block or disconnect it right away.
      *
-     * ⚠️ *Note: This function is **not thread-safe** and **not reentrant**.
-     * Specifically, this means it is undefined behavior to emit a signal from
-     * a slot of that same signal.*
+     * ⚠️ *Note: This function is **not thread-safe**, see ThreadSafeSignal for a Signal
+     * that can be emitted on multiple threads.*
      */
-    void emit(Args... p) const
+    void emit(const Args &...p) const
     {
         if (m_impl)
             m_impl->emit(p...);
@@ -573,13 +1012,56 @@ public:
         // if m_impl is nullptr, we don't have any slots connected, don't bother emitting
     }
 
+    /**
+     * Emits the Signal once for every element of the batch.
+     *
+     * Compared to calling emit() for every element, the Signal only needs to look up each of
+     * its connections once. Each slot is then called with all elements of the batch in order,
+     * before the next slot is called.
+     * Slots connected with connectBatch() receive the whole batch in a single call.
+     *
+     * A slot that blocks or disconnects itself does not receive the remaining elements of the batch.
+     * Otherwise, emitBatch() behaves like emit() with regards to nested emits and
+     * connections that are made or removed while the Signal is emitting.
+     *
+     * Example:
+     * @code
+     * Signal<int, float> signal;
+     * std::vector<std::tuple<int, float>> samples{ { 1, 0.5f }, { 2, 0.25f } };
+     * signal.emitBatch(samples);
+     * @endcode
+     *
+     * ⚠️ *Note: This function is **not thread-safe**.*
+     */
+    void emitBatch(const SignalBatch<Args...> &batch) const
+    {
+        if (m_impl && !batch.empty())
+            m_impl->emitBatch(batch);
+    }
+
+    /**
+     * Sets the name under which this Signal appears in the MetricsRegistry.
+     *
+     * Without a name, a Signal is only tracked once a slot is connected to it.
+     *
+     * Does nothing unless KDBindings is built with metrics enabled (see MetricsRegistry::isEnabled()).
+     */
+    void setMetricsName(std::string_view name)
+    {
+        if constexpr (Private::MetricsEnabled) {
+            ensureImpl();
+            m_impl->metricsRecorder().setName(name);
+        }
+    }
+
 private:
     friend class ConnectionHandle;
 
     void ensureImpl()
     {
         if (!m_impl) {
-            m_impl = std::make_shared<Impl>();
+            auto *resource = pmr::new_delete_resource();
+            m_impl = Private::allocateShared<Impl>(resource, resource);
         }
     }
 
@@ -595,7 +1077,7 @@ private:
     //
     // Think of this shared_ptr more like a unique_ptr with additional weak_ptr's
     // in ConnectionHandle that can check whether the Impl object is still alive.
-    mutable std::shared_ptr<Impl> m_impl;
+    mutable Private::SharedPtr<Impl> m_impl;
 };
 
 /**
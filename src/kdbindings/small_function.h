@@ -0,0 +1,271 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <kdbindings/memory_resource.h>
+
+namespace KDBindings {
+
+namespace Private {
+
+// The default inline capacity of a SmallFunction.
+// This is large enough for lambdas capturing up to four pointers, for the result of
+// bind_first with a member function pointer and an object pointer, and for a std::function.
+inline constexpr std::size_t SmallFunctionDefaultCapacity = 4 * sizeof(void *);
+
+template<typename T>
+struct is_std_function : std::false_type {
+};
+
+template<typename Signature>
+struct is_std_function<std::function<Signature>> : std::true_type {
+};
+
+// Whether a callable of type F is "empty", in the same way that a std::function
+// constructed from it would be empty.
+template<typename F>
+constexpr bool isNullCallable(const F &callable) noexcept
+{
+    if constexpr (std::is_pointer_v<F> || std::is_member_pointer_v<F> || is_std_function<F>::value) {
+        return callable == nullptr;
+    } else {
+        (void)callable;
+        return false;
+    }
+}
+
+// A SmallFunction is a move-only replacement for std::function that stores small
+// callables inline instead of allocating them on the heap.
+//
+// Callables that do not fit into the inline buffer, are over-aligned, or may throw
+// when moved are stored on the heap instead, just like std::function would do.
+// The heap memory comes from a pmr::memory_resource, which can be passed to the
+// constructor with std::allocator_arg, and is pmr::new_delete_resource() otherwise.
+//
+// Calling a SmallFunction is a single indirect call through a function pointer
+// that is generated for the concrete type of the stored callable.
+template<typename Signature, std::size_t Capacity = SmallFunctionDefaultCapacity>
+class SmallFunction;
+
+template<typename R, typename... Args, std::size_t Capacity>
+class SmallFunction<R(Args...), Capacity>
+{
+    static_assert(Capacity >= sizeof(void *), "The inline buffer of a SmallFunction must at least fit a pointer");
+
+public:
+    SmallFunction() noexcept = default;
+
+    SmallFunction(std::nullptr_t) noexcept { }
+
+    template<typename F,
+             typename = std::enable_if_t<
+                     std::conjunction_v<
+                             std::negation<std::is_same<std::decay_t<F>, SmallFunction>>,
+                             std::is_invocable_r<R, std::decay_t<F> &, Args...>>>>
+    SmallFunction(F &&callable)
+        : SmallFunction(std::allocator_arg, pmr::new_delete_resource(), std::forward<F>(callable))
+    {
+    }
+
+    template<typename F,
+             typename = std::enable_if_t<
+                     std::conjunction_v<
+                             std::negation<std::is_same<std::decay_t<F>, SmallFunction>>,
+                             std::is_invocable_r<R, std::decay_t<F> &, Args...>>>>
+    SmallFunction(std::allocator_arg_t, pmr::memory_resource *resource, F &&callable)
+    {
+        using Callable = std::decay_t<F>;
+
+        if (isNullCallable(callable)) {
+            return;
+        }
+
+        if constexpr (storesInline<Callable>()) {
+            (void)resource;
+            ::new (static_cast<void *>(m_storage)) Callable(std::forward<F>(callable));
+            m_invoke = &invokeInline<Callable>;
+            m_manage = &manageInline<Callable>;
+        } else {
+            void *memory = resource->allocate(sizeof(HeapCallable<Callable>), alignof(HeapCallable<Callable>));
+            HeapCallable<Callable> *heapCallable = nullptr;
+            try {
+                heapCallable = ::new (memory) HeapCallable<Callable>{ Callable(std::forward<F>(callable)), resource };
+            } catch (...) {
+                resource->deallocate(memory, sizeof(HeapCallable<Callable>), alignof(HeapCallable<Callable>));
+                throw;
+            }
+            ::new (static_cast<void *>(m_storage)) HeapCallable<Callable> *(heapCallable);
+            m_invoke = &invokeHeap<Callable>;
+            m_manage = &manageHeap<Callable>;
+        }
+    }
+
+    // SmallFunctions are not copyable, as this would require all stored callables
+    // to be copyable as well.
+    SmallFunction(const SmallFunction &) = delete;
+    SmallFunction &operator=(const SmallFunction &) = delete;
+
+    SmallFunction(SmallFunction &&other) noexcept
+    {
+        moveFrom(other);
+    }
+
+    SmallFunction &operator=(SmallFunction &&other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    ~SmallFunction() noexcept
+    {
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        if (m_manage) {
+            m_manage(Operation::Destroy, m_storage, nullptr);
+        }
+        m_invoke = nullptr;
+        m_manage = nullptr;
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return m_invoke != nullptr;
+    }
+
+    // Like std::function, calling a SmallFunction is const, even though the stored
+    // callable may be mutable.
+    R operator()(Args... args) const
+    {
+        return m_invoke(m_storage, std::forward<Args>(args)...);
+    }
+
+    // Whether a callable of the given type will be stored inside the SmallFunction
+    // without allocating any memory.
+    template<typename Callable>
+    static constexpr bool storesInline() noexcept
+    {
+        return sizeof(Callable) <= Capacity &&
+                alignof(Callable) <= alignof(std::max_align_t) &&
+                std::is_nothrow_move_constructible_v<Callable>;
+    }
+
+private:
+    enum class Operation {
+        Move,
+        Destroy
+    };
+
+    // A callable that is stored on the heap remembers the memory resource it was allocated from.
+    template<typename Callable>
+    struct HeapCallable {
+        Callable callable;
+        pmr::memory_resource *resource;
+    };
+
+    using Invoker = R (*)(void *, Args &&...);
+    using Manager = void (*)(Operation, void *, void *) noexcept;
+
+    template<typename Callable>
+    static R invokeInline(void *storage, Args &&...args)
+    {
+        if constexpr (std::is_member_pointer_v<Callable>) {
+            // Member pointers are read without std::launder, like std::function does, as std::launder hides
+            // the stored value from the optimizer. GCC then can't tell whether a member function pointer
+            // is virtual, and warns about reading a vtable pointer from objects that don't have one (-Warray-bounds).
+            Callable memberPointer = *reinterpret_cast<const Callable *>(storage);
+            return invokeCallable(memberPointer, std::forward<Args>(args)...);
+        } else {
+            return invokeCallable(*std::launder(reinterpret_cast<Callable *>(storage)), std::forward<Args>(args)...);
+        }
+    }
+
+    template<typename Callable>
+    static R invokeCallable(Callable &callable, Args &&...args)
+    {
+        if constexpr (std::is_void_v<R>) {
+            std::invoke(callable, std::forward<Args>(args)...);
+        } else {
+            return std::invoke(callable, std::forward<Args>(args)...);
+        }
+    }
+
+    template<typename Callable>
+    static void manageInline(Operation operation, void *storage, void *source) noexcept
+    {
+        switch (operation) {
+        case Operation::Move: {
+            auto &sourceCallable = *std::launder(reinterpret_cast<Callable *>(source));
+            ::new (storage) Callable(std::move(sourceCallable));
+            sourceCallable.~Callable();
+            break;
+        }
+        case Operation::Destroy:
+            std::launder(reinterpret_cast<Callable *>(storage))->~Callable();
+            break;
+        }
+    }
+
+    template<typename Callable>
+    static R invokeHeap(void *storage, Args &&...args)
+    {
+        return invokeCallable((*std::launder(reinterpret_cast<HeapCallable<Callable> **>(storage)))->callable, std::forward<Args>(args)...);
+    }
+
+    template<typename Callable>
+    static void manageHeap(Operation operation, void *storage, void *source) noexcept
+    {
+        switch (operation) {
+        case Operation::Move:
+            // Only the pointer needs to be moved, the callable itself stays where it is.
+            ::new (storage) HeapCallable<Callable> *(*std::launder(reinterpret_cast<HeapCallable<Callable> **>(source)));
+            break;
+        case Operation::Destroy: {
+            auto *heapCallable = *std::launder(reinterpret_cast<HeapCallable<Callable> **>(storage));
+            auto *resource = heapCallable->resource;
+            heapCallable->~HeapCallable();
+            resource->deallocate(heapCallable, sizeof(HeapCallable<Callable>), alignof(HeapCallable<Callable>));
+            break;
+        }
+        }
+    }
+
+    void moveFrom(SmallFunction &other) noexcept
+    {
+        if (other.m_manage) {
+            other.m_manage(Operation::Move, m_storage, other.m_storage);
+        }
+        m_invoke = other.m_invoke;
+        m_manage = other.m_manage;
+        other.m_invoke = nullptr;
+        other.m_manage = nullptr;
+    }
+
+    alignas(std::max_align_t) mutable unsigned char m_storage[Capacity];
+    Invoker m_invoke = nullptr;
+    Manager m_manage = nullptr;
+};
+
+} // namespace Private
+
+} // namespace KDBindings
@@ -0,0 +1,94 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#pragma once
+
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace KDBindings {
+
+template<typename Signature, typename... Slots>
+class StaticSignal;
+
+/**
+ * @brief A StaticSignal is a Signal whose slots are fixed at compile time.
+ *
+ * The Signature template parameter describes the values the StaticSignal emits (e.g. `void(int, float)`),
+ * the Slots are the types of the callables it calls.
+ * Usually the Slots are deduced by makeStaticSignal.
+ *
+ * A StaticSignal stores its slots by value, in the order they were given.
+ * Emitting a StaticSignal calls each slot directly, in that order.
+ * There is no heap allocation, no type erasure and no indirect call involved,
+ * so the compiler is able to inline the slots into the emit call.
+ *
+ * In exchange, slots can not be connected or disconnected at runtime, and there are no ConnectionHandles.
+ *
+ * A StaticSignal has the same emit syntax as a Signal, so code that emits a Signal can
+ * switch to a StaticSignal without changes.
+ *
+ * Example:
+ * @code
+ * int sum = 0;
+ * auto signal = makeStaticSignal<void(int)>(
+ *         [&sum](int value) { sum += value; },
+ *         [](int value) { std::cout << value << std::endl; });
+ * signal.emit(5);
+ * @endcode
+ */
+template<typename... Args, typename... Slots>
+class StaticSignal<void(Args...), Slots...>
+{
+    static_assert(
+            std::conjunction<std::negation<std::is_rvalue_reference<Args>>...>::value,
+            "R-value references are not allowed as Signal parameters!");
+    static_assert(
+            std::conjunction<std::is_invocable<Slots &, const Args &...>...>::value,
+            "All slots of a StaticSignal must be callable with the values the StaticSignal emits!");
+
+public:
+    /** Constructs a StaticSignal that calls the given slots when it is emitted. */
+    constexpr explicit StaticSignal(Slots... slots)
+        : m_slots(std::move(slots)...)
+    {
+    }
+
+    /**
+     * Emits the StaticSignal, which calls all of its slots in order.
+     *
+     * Like Signal::emit, the arguments are passed to each slot by const reference.
+     */
+    void emit(const Args &...p) const
+    {
+        std::apply([&p...](Slots &...slots) { (std::invoke(slots, p...), ...); }, m_slots);
+    }
+
+private:
+    // Like Signal, emitting is const, even though the slots may be mutable.
+    mutable std::tuple<Slots...> m_slots;
+};
+
+/**
+ * Creates a StaticSignal with the given Signature that calls the given slots.
+ *
+ * @code
+ * auto signal = makeStaticSignal<void(int)>([](int value) { ... });
+ * @endcode
+ */
+template<typename Signature, typename... Slots>
+constexpr StaticSignal<Signature, std::decay_t<Slots>...> makeStaticSignal(Slots &&...slots)
+{
+    return StaticSignal<Signature, std::decay_t<Slots>...>(std::forward<Slots>(slots)...);
+}
+
+} // namespace KDBindings
@@ -0,0 +1,541 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <kdbindings/genindex_array.h>
+#include <kdbindings/signal.h>
+#include <kdbindings/small_function.h>
+#include <kdbindings/utils.h>
+
+#include <kdbindings/KDBindingsConfig.h>
+
+#ifdef KDBINDINGS_SINGLE_THREADED
+#error "ThreadSafeSignal is not available when KDBindings is built with KDBINDINGS_SINGLE_THREADED"
+#endif
+
+namespace KDBindings {
+
+namespace Private {
+
+// Counts the threads that are currently reading from a ThreadSafeSignal.
+//
+// The count is split into multiple cache-line sized stripes, so that threads
+// emitting the same signal concurrently don't all contend on the same cache line.
+//
+// Readers are counted separately for the two most recent epochs of the signal (see ThreadSafeSignal::Impl),
+// so that the readers of the previous epoch can finish while new readers enter the current one.
+class StripedReaderCount
+{
+public:
+    static constexpr std::size_t StripeCount = 8;
+
+    // Returns the stripe the calling thread should use.
+    static std::size_t stripeIndex() noexcept
+    {
+        static std::atomic<std::size_t> s_nextStripe{ 0 };
+        static thread_local const std::size_t t_stripe = s_nextStripe.fetch_add(1, std::memory_order_relaxed) % StripeCount;
+        return t_stripe;
+    }
+
+    void enter(std::size_t stripe, std::size_t epoch) noexcept
+    {
+        m_stripes[stripe].counts[epoch % 2].fetch_add(1);
+    }
+
+    void leave(std::size_t stripe, std::size_t epoch) noexcept
+    {
+        m_stripes[stripe].counts[epoch % 2].fetch_sub(1);
+    }
+
+    // Whether no thread is currently reading in the given epoch.
+    // Note that this is only a snapshot, new readers may enter at any time.
+    bool isQuiescent(std::size_t epoch) const noexcept
+    {
+        for (const auto &stripe : m_stripes) {
+            if (stripe.counts[epoch % 2].load() != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    struct alignas(64) Stripe {
+        std::array<std::atomic<std::size_t>, 2> counts{};
+    };
+
+    std::array<Stripe, StripeCount> m_stripes;
+};
+
+} // namespace Private
+
+/**
+ * @brief A ThreadSafeSignal is a Signal that can be emitted, connected to and disconnected from
+ * on multiple threads at the same time.
+ *
+ * Emitting a ThreadSafeSignal never takes a lock.
+ * The connections of the signal are kept in an immutable snapshot.
+ * Emitting reads the current snapshot and calls the slots in it, so any number of threads
+ * can emit the same ThreadSafeSignal concurrently without waiting for each other.
+ *
+ * Connecting, disconnecting and blocking are serialized with a mutex.
+ * Connecting and disconnecting copy the current snapshot, modify the copy and publish it as the new
+ * snapshot (copy-on-write). Therefore they are O(number of connections), whilst emitting is only
+ * affected by the number of connections it actually calls.
+ *
+ * Snapshots that have been replaced are kept alive until all threads that were emitting the signal
+ * at that time are done, even if other threads keep emitting it in the meantime.
+ * Therefore a slot is never destroyed while it is still being called, even if it was disconnected
+ * on another thread in the meantime.
+ *
+ * Compared to Signal, a ThreadSafeSignal has a few restrictions:
+ * - A slot may still be called once after it was disconnected, if another thread was in the middle of emitting
+ *   the signal at the time. When disconnect() returns, the slot may also still be running on another thread.
+ * - Reflective and deferred connections are not supported.
+ * - Each ThreadSafeSignal allocates its internal state when it is constructed.
+ *
+ * Like with Signal, slots are called in the order they were connected.
+ *
+ * ConnectionHandle, ScopedConnection and ConnectionBlocker work with a ThreadSafeSignal the same way
+ * they work with a Signal, and are safe to use from any thread.
+ *
+ * @warning Connecting functions to a signal that throw an exception when called is currently undefined behavior.
+ */
+template<typename... Args>
+class ThreadSafeSignal
+{
+    static_assert(
+            std::conjunction<std::negation<std::is_rvalue_reference<Args>>...>::value,
+            "R-value references are not allowed as Signal parameters!");
+
+    class Impl : public Private::SignalImplBase
+    {
+    public:
+        Impl()
+            : m_snapshot(new Snapshot)
+        {
+        }
+
+        ~Impl() noexcept
+        {
+            // Nobody can emit the signal anymore, so everything can be deleted.
+            delete m_snapshot.load();
+            for (const auto &retired : m_retiredSnapshots) {
+                delete retired.snapshot;
+            }
+        }
+
+        Impl(Impl const &other) = delete;
+        Impl &operator=(Impl const &other) = delete;
+        Impl(Impl &&other) = delete;
+        Impl &operator=(Impl &&other) = delete;
+
+        template<typename Func>
+        Private::GenerationalIndex connect(Func &&slot)
+        {
+            auto connection = std::make_shared<Connection>(std::forward<Func>(slot));
+
+            std::vector<Snapshot *> reclaimed;
+            Private::GenerationalIndex id;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                id = m_connections.insert(std::shared_ptr<Connection>(connection));
+
+                auto *snapshot = new Snapshot{ currentSnapshot()->connections };
+                snapshot->connections.emplace_back(std::move(connection));
+                reclaimed = publish(snapshot);
+            }
+            deleteSnapshots(reclaimed);
+            return id;
+        }
+
+        void disconnect(const ConnectionHandle &handle) noexcept override
+        {
+            if (!handle.m_id.has_value()) {
+                return;
+            }
+
+            std::vector<Snapshot *> reclaimed;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto *connection = m_connections.get(*handle.m_id);
+                if (!connection) {
+                    return;
+                }
+                // Any thread that is still emitting an older snapshot should no longer call this slot.
+                (*connection)->disconnected.store(true);
+
+                auto *snapshot = new Snapshot;
+                const auto &connections = currentSnapshot()->connections;
+                snapshot->connections.reserve(connections.size() - 1);
+                for (const auto &existing : connections) {
+                    if (existing != *connection) {
+                        snapshot->connections.push_back(existing);
+                    }
+                }
+                m_connections.erase(*handle.m_id);
+                reclaimed = publish(snapshot);
+            }
+            deleteSnapshots(reclaimed);
+        }
+
+        void disconnectAll() noexcept
+        {
+            std::vector<Snapshot *> reclaimed;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (const auto &connection : currentSnapshot()->connections) {
+                    connection->disconnected.store(true);
+                }
+                m_connections.clear();
+                reclaimed = publish(new Snapshot);
+            }
+            deleteSnapshots(reclaimed);
+        }
+
+        bool blockConnection(const Private::GenerationalIndex &id, bool blocked) override
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto *connection = m_connections.get(id);
+            if (!connection) {
+                throw std::out_of_range("Provided ConnectionHandle does not match any connection\nLikely the connection was deleted before!");
+            }
+            return (*connection)->blocked.exchange(blocked);
+        }
+
+        bool isConnectionActive(const Private::GenerationalIndex &id) const noexcept override
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_connections.get(id) != nullptr;
+        }
+
+        bool isConnectionBlocked(const Private::GenerationalIndex &id) const override
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto *connection = m_connections.get(id);
+            if (!connection) {
+                throw std::out_of_range("Provided ConnectionHandle does not match any connection\nLikely the connection was deleted before!");
+            }
+            return (*connection)->blocked.load();
+        }
+
+        void emit(const Args &...p)
+        {
+            const auto stripe = Private::StripedReaderCount::stripeIndex();
+            {
+                ReadGuard guard(m_readers, stripe, m_epoch.load());
+
+                // The reader count must be incremented before loading the snapshot.
+                // A writer that replaces the snapshot afterwards will then see that we may
+                // still be using it and won't delete it.
+                // If the epoch changed in the meantime, we're counted as a reader of an older epoch,
+                // which only delays deleting snapshots that are replaced later.
+                const Snapshot *snapshot = m_snapshot.load();
+                for (const auto &connection : snapshot->connections) {
+                    if (!connection->blocked.load(std::memory_order_relaxed) && !connection->disconnected.load(std::memory_order_relaxed)) {
+                        connection->slot(p...);
+                    }
+                }
+            }
+
+            // If we were the last thread emitting, we may now be able to delete old snapshots.
+            if (m_hasRetiredSnapshots.load(std::memory_order_relaxed)) {
+                std::vector<Snapshot *> reclaimed;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+                    if (lock.owns_lock()) {
+                        reclaimed = takeReclaimableSnapshots();
+                    }
+                }
+                deleteSnapshots(reclaimed);
+            }
+        }
+
+    private:
+        struct Connection {
+            template<typename Func>
+            explicit Connection(Func &&func)
+                : slot(std::forward<Func>(func))
+            {
+            }
+
+            Private::SmallFunction<void(const Args &...)> slot;
+            std::atomic<bool> blocked{ false };
+            std::atomic<bool> disconnected{ false };
+        };
+
+        struct Snapshot {
+            std::vector<std::shared_ptr<Connection>> connections;
+        };
+
+        class ReadGuard
+        {
+        public:
+            ReadGuard(Private::StripedReaderCount &readers, std::size_t stripe, std::size_t epoch) noexcept
+                : m_readers(readers), m_stripe(stripe), m_epoch(epoch)
+            {
+                m_readers.enter(m_stripe, m_epoch);
+            }
+
+            ~ReadGuard() noexcept
+            {
+                m_readers.leave(m_stripe, m_epoch);
+            }
+
+            ReadGuard(const ReadGuard &) = delete;
+            ReadGuard &operator=(const ReadGuard &) = delete;
+
+        private:
+            Private::StripedReaderCount &m_readers;
+            std::size_t m_stripe;
+            std::size_t m_epoch;
+        };
+
+        struct RetiredSnapshot {
+            Snapshot *snapshot;
+            // The epoch in which the snapshot was replaced.
+            std::size_t epoch;
+        };
+
+        // Must be called with m_mutex locked.
+        Snapshot *currentSnapshot() const noexcept
+        {
+            return m_snapshot.load();
+        }
+
+        // Must be called with m_mutex locked.
+        // Returns the snapshots that can be deleted, which should be done after unlocking
+        // the mutex, as deleting them may run arbitrary destructors of slots.
+        std::vector<Snapshot *> publish(Snapshot *snapshot)
+        {
+            m_retiredSnapshots.push_back({ m_snapshot.exchange(snapshot), m_epoch.load() });
+            m_hasRetiredSnapshots.store(true, std::memory_order_relaxed);
+            return takeReclaimableSnapshots();
+        }
+
+        // Must be called with m_mutex locked.
+        //
+        // Any thread that loaded one of the retired snapshots incremented the reader count of the epoch it saw
+        // before doing so, and will only decrement it when it's done.
+        // A snapshot that was replaced before the current epoch started can therefore only still be used
+        // by readers of the previous epoch: The readers that are counted in the current epoch either loaded
+        // a newer snapshot, or were already done when the current epoch started.
+        // Once the previous epoch has no readers anymore, these snapshots can be deleted, and a new epoch is started
+        // for the snapshots that were replaced in the current one.
+        //
+        // New readers always enter the current epoch, so the previous epoch eventually runs out of readers,
+        // even if other threads emit the signal all the time.
+        std::vector<Snapshot *> takeReclaimableSnapshots()
+        {
+            std::vector<Snapshot *> reclaimed;
+            auto epoch = m_epoch.load();
+            while (!m_retiredSnapshots.empty() && m_readers.isQuiescent(epoch - 1)) {
+                // The snapshots are retired in order, so the ones of older epochs are at the front.
+                auto retired = m_retiredSnapshots.begin();
+                for (; retired != m_retiredSnapshots.end() && retired->epoch != epoch; ++retired) {
+                    reclaimed.push_back(retired->snapshot);
+                }
+                m_retiredSnapshots.erase(m_retiredSnapshots.begin(), retired);
+                if (!m_retiredSnapshots.empty()) {
+                    // Readers of the new epoch are counted with the readers of the previous epoch,
+                    // which is why a new epoch can only start once they're done.
+                    m_epoch.store(++epoch);
+                }
+            }
+            m_hasRetiredSnapshots.store(!m_retiredSnapshots.empty(), std::memory_order_relaxed);
+            return reclaimed;
+        }
+
+        static void deleteSnapshots(const std::vector<Snapshot *> &snapshots) noexcept
+        {
+            for (auto *snapshot : snapshots) {
+                delete snapshot;
+            }
+        }
+
+        std::atomic<Snapshot *> m_snapshot;
+        Private::StripedReaderCount m_readers;
+        // Only changed with m_mutex locked.
+        std::atomic<std::size_t> m_epoch{ 0 };
+
+        mutable std::mutex m_mutex;
+        // The connections by id, so ConnectionHandles can look them up.
+        // Protected by m_mutex.
+        Private::GenerationalIndexArray<std::shared_ptr<Connection>> m_connections;
+        // Snapshots that have been replaced, but may still be in use by an emitting thread.
+        // Protected by m_mutex.
+        std::vector<RetiredSnapshot> m_retiredSnapshots;
+        std::atomic<bool> m_hasRetiredSnapshots{ false };
+    };
+
+public:
+    /** ThreadSafeSignals are default constructible */
+    ThreadSafeSignal()
+        : m_impl(std::make_shared<Impl>())
+    {
+    }
+
+    /** ThreadSafeSignals cannot be copied. */
+    ThreadSafeSignal(const ThreadSafeSignal &) = delete;
+    ThreadSafeSignal &operator=(ThreadSafeSignal const &other) = delete;
+
+    /**
+     * ThreadSafeSignals can be moved.
+     *
+     * Moving is not thread-safe, no other thread may use either of the signals while they are moved.
+     */
+    ThreadSafeSignal(ThreadSafeSignal &&other) noexcept = default;
+    ThreadSafeSignal &operator=(ThreadSafeSignal &&other) noexcept = default;
+
+    /**
+     * A ThreadSafeSignal disconnects all slots when it is destructed.
+     *
+     * No other thread may emit the signal while it is destructed.
+     */
+    ~ThreadSafeSignal() noexcept
+    {
+        disconnectAll();
+    }
+
+    /**
+     * Connects a std::function to the signal.
+     *
+     * This function is thread-safe.
+     *
+     * @return An instance of ConnectionHandle, that can be used to disconnect
+     * or temporarily block the connection.
+     */
+    KDBINDINGS_WARN_UNUSED ConnectionHandle connect(std::function<void(Args...)> const &slot)
+    {
+        return ConnectionHandle{ m_impl, m_impl->connect(slot) };
+    }
+
+    /**
+     * Connects an arbitrary callable to the signal, binding any provided arguments to it and
+     * discarding any values emitted by this signal that aren't needed by the resulting function.
+     *
+     * This behaves the same as the equivalent Signal::connect overload.
+     *
+     * This function is thread-safe.
+     *
+     * @return An instance of ConnectionHandle, that can be used to disconnect
+     * or temporarily block the connection.
+     */
+    template<typename Func, typename... FuncArgs, typename = std::enable_if_t<std::disjunction_v<std::negation<std::is_same<std::decay_t<Func>, std::function<void(Args...)>>>, std::integral_constant<bool, sizeof...(FuncArgs) /*Also enable this function if we want to bind at least one argument*/>>>>
+    KDBINDINGS_WARN_UNUSED ConnectionHandle connect(Func &&slot, FuncArgs &&...args)
+    {
+        if constexpr (sizeof...(FuncArgs) == 0 && std::is_invocable_v<std::decay_t<Func> &, const Args &...>) {
+            return ConnectionHandle{ m_impl, m_impl->connect(std::forward<Func>(slot)) };
+        } else {
+            return ConnectionHandle{ m_impl, m_impl->connect(Private::bind_first(std::forward<Func>(slot), std::forward<FuncArgs>(args)...)) };
+        }
+    }
+
+    /**
+     * Disconnect a previously connected slot.
+     *
+     * This function is thread-safe.
+     * Note that the slot may still be running on another thread when this function returns.
+     *
+     * @throw std::out_of_range - If the ConnectionHandle does not belong to this
+     * ThreadSafeSignal (i.e. ConnectionHandle::belongsTo returns false).
+     */
+    void disconnect(const ConnectionHandle &handle)
+    {
+        if (m_impl && handle.belongsTo(*this) && handle.m_id.has_value()) {
+            m_impl->disconnect(handle);
+        } else {
+            throw std::out_of_range("Provided ConnectionHandle does not match any connection\nLikely the connection was deleted before!");
+        }
+    }
+
+    /**
+     * Disconnect all previously connected functions.
+     *
+     * This function is thread-safe.
+     */
+    void disconnectAll() noexcept
+    {
+        if (m_impl) {
+            m_impl->disconnectAll();
+        }
+    }
+
+    /**
+     * Sets the block state of the connection.
+     *
+     * This function is thread-safe.
+     *
+     * @return Whether the connection was previously blocked.
+     * @throw std::out_of_range - If the ConnectionHandle does not belong to this
+     * ThreadSafeSignal (i.e. ConnectionHandle::belongsTo returns false).
+     */
+    bool blockConnection(const ConnectionHandle &handle, bool blocked)
+    {
+        if (m_impl && handle.belongsTo(*this) && handle.m_id.has_value()) {
+            return m_impl->blockConnection(*handle.m_id, blocked);
+        } else {
+            throw std::out_of_range("Provided ConnectionHandle does not match any connection\nLikely the connection was deleted before!");
+        }
+    }
+
+    /**
+     * Checks whether the connection is currently blocked.
+     *
+     * This function is thread-safe.
+     *
+     * @throw std::out_of_range - If the ConnectionHandle does not belong to this
+     * ThreadSafeSignal (i.e. ConnectionHandle::belongsTo returns false).
+     */
+    bool isConnectionBlocked(const ConnectionHandle &handle) const
+    {
+        if (m_impl && handle.belongsTo(*this) && handle.m_id.has_value()) {
+            return m_impl->isConnectionBlocked(*handle.m_id);
+        } else {
+            throw std::out_of_range("Provided ConnectionHandle does not match any connection\nLikely the connection was deleted before!");
+        }
+    }
+
+    /**
+     * Emits the signal, which causes all connected slots to be called,
+     * as long as they are not blocked.
+     *
+     * The arguments are passed to each slot by const reference.
+     *
+     * This function is thread-safe and lock-free, it can be called on any number of threads at the same time.
+     * It is also reentrant, slots may emit the signal again, as well as connect and disconnect slots.
+     * Slots connected during an emit are not called by that emit.
+     */
+    void emit(const Args &...p) const
+    {
+        if (m_impl) {
+            m_impl->emit(p...);
+        }
+    }
+
+private:
+    friend class ConnectionHandle;
+
+    // Only a moved-from ThreadSafeSignal has no Impl.
+    std::shared_ptr<Impl> m_impl;
+};
+
+} // namespace KDBindings
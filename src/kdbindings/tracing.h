@@ -0,0 +1,282 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace KDBindings {
+
+namespace Private {
+class ChromeTraceWriter;
+class TraceScope;
+template<typename Func>
+decltype(auto) traceDeferred(Func &&invocation);
+} // namespace Private
+
+/**
+ * @brief The Tracer records how Signal emits, slots, Binding evaluations and deferred connections cause each other.
+ *
+ * Tracing is only available if KDBindings is built with the KDBindings_ENABLE_TRACING CMake option
+ * (i.e. KDBINDINGS_ENABLE_TRACING is defined). Otherwise, the Tracer never records anything and the
+ * instrumentation compiles to nothing.
+ *
+ * While the Tracer is recording, every Property::set, Signal::emit, slot call, Binding::evaluate and
+ * ConnectionEvaluator::evaluateDeferredConnections is recorded as a span. Spans that are started while
+ * another span is running on the same thread are its children. A deferred slot is a child of the
+ * emit that queued it, even if it is evaluated on another thread.
+ *
+ * The recorded spans can be written in the Chrome Trace Event format with writeChromeTrace() from
+ * kdbindings/tracing_json.h, and inspected with any viewer for that format, e.g. chrome://tracing or Perfetto.
+ *
+ * Example:
+ * @code
+ * Tracer::instance().start();
+ * myProperty = 42; // Triggers a cascade of Binding evaluations
+ * Tracer::instance().stop();
+ * writeChromeTraceFile("kdbindings.trace.json");
+ * @endcode
+ */
+class Tracer
+{
+public:
+    /** Whether KDBindings was built with tracing enabled. */
+    static constexpr bool isEnabled() noexcept
+    {
+#ifdef KDBINDINGS_ENABLE_TRACING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /** Returns the Tracer that records all spans. */
+    static Tracer &instance()
+    {
+        // Like the MetricsRegistry, the Tracer is never destroyed, so spans that end after main can still be recorded.
+        alignas(Tracer) static unsigned char storage[sizeof(Tracer)];
+        static Tracer *tracer = ::new (static_cast<void *>(storage)) Tracer();
+        return *tracer;
+    }
+
+    Tracer(const Tracer &) = delete;
+    Tracer &operator=(const Tracer &) = delete;
+
+    /**
+     * Discards all previously recorded spans and starts recording.
+     *
+     * Once maxEvents spans have been recorded, further spans are dropped (see droppedEvents()),
+     * so that a forgotten Tracer does not use up all memory.
+     *
+     * Does nothing unless tracing is enabled (see isEnabled()).
+     */
+    void start(std::size_t maxEvents = 1000000)
+    {
+        if constexpr (isEnabled()) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_events.clear();
+            m_maxEvents = maxEvents;
+            m_droppedEvents = 0;
+            m_startTime.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+            m_recording.store(true, std::memory_order_release);
+        }
+    }
+
+    /** Stops recording. The recorded spans are kept until the next call to start(). */
+    void stop() noexcept
+    {
+        m_recording.store(false, std::memory_order_release);
+    }
+
+    /** Whether the Tracer is currently recording. */
+    bool isRecording() const noexcept
+    {
+        return m_recording.load(std::memory_order_relaxed);
+    }
+
+    /** The number of events that were recorded since the last call to start(). */
+    std::size_t eventCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_events.size();
+    }
+
+    /** The number of events that were dropped since the last call to start(), because maxEvents was reached. */
+    std::size_t droppedEvents() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_droppedEvents;
+    }
+
+private:
+    friend class Private::ChromeTraceWriter;
+    friend class Private::TraceScope;
+    template<typename Func>
+    friend decltype(auto) Private::traceDeferred(Func &&invocation);
+
+    Tracer() = default;
+
+    struct Event {
+        const char *name;
+        const char *category;
+        char phase;
+        uint64_t timestamp;
+        uint64_t duration;
+        uint64_t threadId;
+        uint64_t id;
+        uint64_t parentId;
+        const void *object;
+    };
+
+    // The id of the span that is currently running on this thread, 0 if there is none.
+    static uint64_t &currentSpan() noexcept
+    {
+        thread_local uint64_t span = 0;
+        return span;
+    }
+
+    static uint64_t threadId() noexcept
+    {
+        static std::atomic<uint64_t> nextThreadId{ 1 };
+        thread_local const uint64_t id = nextThreadId.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+
+    uint64_t nextId() noexcept
+    {
+        return m_nextId.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Nanoseconds since the Tracer was started.
+    uint64_t now() const noexcept
+    {
+        const std::chrono::steady_clock::time_point start(std::chrono::steady_clock::duration(m_startTime.load(std::memory_order_relaxed)));
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        return elapsed > 0 ? static_cast<uint64_t>(elapsed) : 0;
+    }
+
+    // Events are recorded when a span ends, which may be in a destructor, so this must not throw.
+    void record(const Event &event) noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_events.size() >= m_maxEvents) {
+            ++m_droppedEvents;
+            return;
+        }
+        try {
+            m_events.push_back(event);
+        } catch (...) {
+            ++m_droppedEvents;
+        }
+    }
+
+    std::atomic<bool> m_recording{ false };
+    std::atomic<uint64_t> m_nextId{ 1 };
+    std::atomic<std::chrono::steady_clock::rep> m_startTime{ 0 };
+    mutable std::mutex m_mutex;
+    std::vector<Event> m_events;
+    std::size_t m_maxEvents = 0;
+    std::size_t m_droppedEvents = 0;
+};
+
+namespace Private {
+
+#ifdef KDBINDINGS_ENABLE_TRACING
+
+// Records a span from its construction to its destruction while the Tracer is recording.
+class TraceScope
+{
+public:
+    TraceScope(const char *category, const char *name, const void *object) noexcept
+        : TraceScope(category, name, object, Tracer::currentSpan())
+    {
+    }
+
+    TraceScope(const char *category, const char *name, const void *object, uint64_t parentId) noexcept
+    {
+        auto &tracer = Tracer::instance();
+        if (!tracer.isRecording()) {
+            return;
+        }
+        m_event = { name, category, 'X', tracer.now(), 0, Tracer::threadId(), tracer.nextId(), parentId, object };
+        m_previousSpan = std::exchange(Tracer::currentSpan(), m_event.id);
+    }
+
+    ~TraceScope()
+    {
+        if (m_event.id == 0) {
+            return;
+        }
+        Tracer::currentSpan() = m_previousSpan;
+        auto &tracer = Tracer::instance();
+        // If the Tracer was restarted while the span was running, its timestamp is meaningless,
+        // but it must not lead to a huge duration either.
+        const auto end = tracer.now();
+        m_event.duration = end > m_event.timestamp ? end - m_event.timestamp : 0;
+        tracer.record(m_event);
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    Tracer::Event m_event{ nullptr, nullptr, 'X', 0, 0, 0, 0, 0, nullptr };
+    uint64_t m_previousSpan = 0;
+};
+
+// Wraps a deferred slot invocation, so that it is recorded as a child of the span that queued it.
+template<typename Func>
+decltype(auto) traceDeferred(Func &&invocation)
+{
+    auto &tracer = Tracer::instance();
+    uint64_t cause = 0;
+    uint64_t flowId = 0;
+    if (tracer.isRecording()) {
+        cause = Tracer::currentSpan();
+        flowId = tracer.nextId();
+        tracer.record({ "deferred", "evaluator", 's', tracer.now(), 0, Tracer::threadId(), flowId, cause, nullptr });
+    }
+    return [cause, flowId, invocation = std::forward<Func>(invocation)]() mutable {
+        TraceScope scope("evaluator", "deferred slot", nullptr, cause);
+        auto &tracer = Tracer::instance();
+        if (flowId != 0 && tracer.isRecording()) {
+            tracer.record({ "deferred", "evaluator", 'f', tracer.now(), 0, Tracer::threadId(), flowId, cause, nullptr });
+        }
+        invocation();
+    };
+}
+
+#else
+
+// Without KDBINDINGS_ENABLE_TRACING, spans are not recorded and the compiler removes them entirely.
+class TraceScope
+{
+public:
+    TraceScope(const char *, const char *, const void *) noexcept { }
+};
+
+template<typename Func>
+decltype(auto) traceDeferred(Func &&invocation)
+{
+    return std::forward<Func>(invocation);
+}
+
+#endif
+
+} // namespace Private
+
+} // namespace KDBindings
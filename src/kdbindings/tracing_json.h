@@ -0,0 +1,102 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+#include <kdbindings/tracing.h>
+
+namespace KDBindings {
+
+namespace Private {
+
+class ChromeTraceWriter
+{
+public:
+    static void write(const Tracer &tracer, std::ostream &stream)
+    {
+        std::lock_guard<std::mutex> lock(tracer.m_mutex);
+
+        stream << "{\n  \"displayTimeUnit\": \"ns\",\n  \"traceEvents\": [";
+        for (std::size_t i = 0; i < tracer.m_events.size(); ++i) {
+            const auto &event = tracer.m_events[i];
+            stream << (i == 0 ? "\n" : ",\n")
+                   << "    { \"name\": \"" << event.name << "\", \"cat\": \"" << event.category
+                   << "\", \"ph\": \"" << event.phase << "\", \"ts\": ";
+            writeMicroseconds(stream, event.timestamp);
+            stream << ", \"pid\": 1, \"tid\": " << event.threadId;
+            switch (event.phase) {
+            case 'X':
+                stream << ", \"dur\": ";
+                writeMicroseconds(stream, event.duration);
+                stream << ", \"args\": { \"id\": " << event.id << ", \"parent\": " << event.parentId
+                       << ", \"object\": \"" << event.object << "\" }";
+                break;
+            case 's':
+                stream << ", \"id\": " << event.id;
+                break;
+            case 'f':
+                stream << ", \"id\": " << event.id << ", \"bp\": \"e\"";
+                break;
+            }
+            stream << " }";
+        }
+        stream << (tracer.m_events.empty() ? "" : "\n  ") << "]\n}\n";
+    }
+
+private:
+    static void writeMicroseconds(std::ostream &stream, uint64_t nanoseconds)
+    {
+        const auto fill = stream.fill('0');
+        stream << nanoseconds / 1000 << '.' << std::setw(3) << nanoseconds % 1000;
+        stream.fill(fill);
+    }
+};
+
+} // namespace Private
+
+/**
+ * Writes the spans that the Tracer recorded to the stream in the Chrome Trace Event format.
+ *
+ * Every span is written as a complete ("X") event, with its own id and the id of its parent
+ * in the "args" of the event. Deferred slots are additionally connected to the emit that
+ * queued them by flow events.
+ *
+ * This lives in its own header, so that Signals and Properties don't need to include the stream headers.
+ */
+inline void writeChromeTrace(std::ostream &stream)
+{
+    Private::ChromeTraceWriter::write(Tracer::instance(), stream);
+}
+
+/**
+ * Writes the recorded spans to the given file (see writeChromeTrace).
+ *
+ * @return whether the file could be written.
+ */
+inline bool writeChromeTraceFile(const std::string &fileName)
+{
+    std::ofstream file(fileName, std::ios::out | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    writeChromeTrace(file);
+    file.flush();
+    return static_cast<bool>(file);
+}
+
+} // namespace KDBindings
@@ -10,6 +10,7 @@
 */
 #pragma once
 
+#include <cstddef>
 #include <functional>
 #include <type_traits>
 #include <utility>
@@ -117,6 +118,11 @@ KDBINDINGS_DEFINE_MEMBER_GET_ARITY(volatile const &noexcept)
 KDBINDINGS_DEFINE_MEMBER_GET_ARITY(volatile &&noexcept)
 KDBINDINGS_DEFINE_MEMBER_GET_ARITY(volatile const &&noexcept)
 
+// ------------------------ CacheLineSize --------------------------
+// Data that is written by different threads is aligned to this size, so that the threads
+// don't invalidate each other's cache lines (false sharing).
+inline constexpr std::size_t CacheLineSize = 64;
+
 // -------------------- placeholder and bind_first ---------------------
 // Inspired by https://gist.github.com/engelmarkus/fc1678adbed1b630584c90219f77eb48
 // A placeholder provides a way to construct something equivalent to a std::placeholders::_N
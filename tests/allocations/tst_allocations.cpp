@@ -0,0 +1,219 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include <kdbindings/binding.h>
+#include <kdbindings/binding_evaluator.h>
+#include <kdbindings/connection_evaluator.h>
+#include <kdbindings/node_operators.h>
+#include <kdbindings/property.h>
+#include <kdbindings/signal.h>
+
+#include <allocation_counter.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+// The expansion of TEST_CASE from doctest leads to a clazy warning.
+// As this issue originates from doctest, disable the warning.
+// clazy:excludeall=non-pod-global-static
+
+using namespace KDBindings;
+
+namespace {
+
+// These tests check the steady state, so every operation is done once before
+// its allocations are counted, e.g. to let containers reach their final capacity.
+constexpr int s_repetitions = 100;
+
+// Returns the number of allocations of s_repetitions calls of the operation.
+template<typename Func>
+std::size_t allocationsOfRepeated(Func &&operation)
+{
+    operation();
+    const AllocationCounter::Scope scope;
+    for (int i = 0; i < s_repetitions; ++i) {
+        operation();
+    }
+    return scope.allocations();
+}
+
+struct Receiver {
+    void onValue(int value) { sum += value; }
+
+    int64_t sum = 0;
+};
+
+} // namespace
+
+TEST_CASE("Operations that must not allocate")
+{
+    SUBCASE("Signal::emit to plain connections")
+    {
+        Receiver receiver;
+        int64_t sum = 0;
+        Signal<int, std::string> signal;
+        (void)signal.connect([&sum](int value, const std::string &) { sum += value; });
+        (void)signal.connect(std::function<void(int, const std::string &)>([&sum](int value, const std::string &) { sum += value; }));
+        (void)signal.connect([&receiver](int value) { receiver.onValue(value); });
+        (void)signal.connectReflective([&sum](ConnectionHandle &, int value, const std::string &) { sum += value; });
+        auto blocked = signal.connect([&sum](int value) { sum += value; });
+        blocked.block(true);
+
+        const std::string text(100, 'x');
+        REQUIRE(allocationsOfRepeated([&] { signal.emit(1, text); }) == 0);
+        REQUIRE(sum > 0);
+    }
+
+    SUBCASE("Signal::emitBatch")
+    {
+        int64_t sum = 0;
+        Signal<int> signal;
+        (void)signal.connect([&sum](int value) { sum += value; });
+        (void)signal.connectBatch([&sum](const SignalBatch<int> &batch) { sum += static_cast<int64_t>(batch.size()); });
+
+        const std::vector<std::tuple<int>> values{ { 1 }, { 2 }, { 3 } };
+        REQUIRE(allocationsOfRepeated([&] { signal.emitBatch(values); }) == 0);
+        REQUIRE(allocationsOfRepeated([&] { signal.emit(4); }) == 0);
+    }
+
+    SUBCASE("Property::set without listeners")
+    {
+        Property<int> property(0);
+        int value = 0;
+        REQUIRE(allocationsOfRepeated([&] { property = ++value; }) == 0);
+    }
+
+    SUBCASE("Property::set with a listener")
+    {
+        Property<std::vector<int>> property;
+        std::size_t size = 0;
+        (void)property.valueChanged().connect([&size](const std::vector<int> &value) { size = value.size(); });
+
+        // Only the new value itself allocates, which happens before set() is called.
+        std::vector<std::vector<int>> values(s_repetitions + 1, std::vector<int>{ 1 });
+        std::size_t next = 0;
+        REQUIRE(allocationsOfRepeated([&] { property = std::move(values[next++]); }) == 0);
+        REQUIRE(size == 1);
+    }
+
+    SUBCASE("Property::set propagating through a Binding with ImmediateBindingEvaluator")
+    {
+        Property<int> source(0);
+        auto bound = makeBoundProperty(source * 2 + 1);
+        int64_t received = 0;
+        (void)bound.valueChanged().connect([&received](int value) { received = value; });
+
+        int value = 0;
+        REQUIRE(allocationsOfRepeated([&] { source = ++value; }) == 0);
+        REQUIRE(bound.get() == value * 2 + 1);
+        REQUIRE(received == bound.get());
+    }
+
+    SUBCASE("BindingEvaluator::evaluateAll without dirty Bindings")
+    {
+        BindingEvaluator evaluator;
+        Property<int> a(1);
+        Property<int> b(2);
+        auto sum = makeBoundProperty(evaluator, a + b);
+        auto product = makeBoundProperty(evaluator, a * b);
+        evaluator.evaluateAll();
+
+        REQUIRE(allocationsOfRepeated([&] { evaluator.evaluateAll(); }) == 0);
+        REQUIRE(sum.get() == 3);
+        REQUIRE(product.get() == 2);
+    }
+
+    SUBCASE("Property::set and BindingEvaluator::evaluateAll with dirty Bindings")
+    {
+        BindingEvaluator evaluator;
+        Property<int> source(0);
+        auto bound = makeBoundProperty(evaluator, source + 1);
+
+        int value = 0;
+        REQUIRE(allocationsOfRepeated([&] {
+                    source = ++value;
+                    evaluator.evaluateAll();
+                })
+                == 0);
+        REQUIRE(bound.get() == value + 1);
+    }
+
+    SUBCASE("Signal::connect and disconnect of small slots")
+    {
+        // Once the Signal has allocated its storage, connections are reused.
+        int64_t sum = 0;
+        Signal<int> signal;
+        REQUIRE(allocationsOfRepeated([&] {
+                    auto handle = signal.connect([&sum](int value) { sum += value; });
+                    handle.disconnect();
+                })
+                == 0);
+    }
+
+    SUBCASE("ConnectionEvaluator::evaluateDeferredConnections without queued invocations")
+    {
+        auto evaluator = std::make_shared<ConnectionEvaluator>();
+        REQUIRE(allocationsOfRepeated([&] { evaluator->evaluateDeferredConnections(); }) == 0);
+    }
+
+    SUBCASE("Signal::emit to deferred connections, and evaluating them")
+    {
+        // The queued invocations share the slot of their connection and store small arguments inline,
+        // and the queue keeps its capacity after the invocations were evaluated.
+        int64_t sum = 0;
+        auto evaluator = std::make_shared<ConnectionEvaluator>();
+        Signal<int> signal;
+        Signal<int64_t, int64_t, int64_t> signal2;
+        (void)signal.connectDeferred(evaluator, [&sum](int value) { sum += value; });
+        (void)signal.connectDeferred(evaluator, [&sum](int value) { sum += value; });
+        (void)signal2.connectDeferred(evaluator, [&sum](int64_t a, int64_t b, int64_t c) { sum += a + b + c; });
+
+        const auto allocations = allocationsOfRepeated([&] {
+            signal.emit(1);
+            signal2.emit(1, 1, 1);
+            evaluator->evaluateDeferredConnections();
+        });
+        REQUIRE(allocations == 0);
+        REQUIRE(sum == 5 * (s_repetitions + 1));
+    }
+}
+
+// Operations that do allocate today. Their budgets are upper bounds,
+// so that changes which add allocations to these paths are noticed.
+TEST_CASE("Allocation budgets")
+{
+    SUBCASE("Signal::connect of a large slot")
+    {
+        // Budget: 1 allocation for the slot, which is too large to be stored inside the connection.
+        constexpr std::size_t budget = 1;
+
+        struct LargeSlot {
+            void operator()(int value) const { *sum += value; }
+            int64_t *sum;
+            char padding[128];
+        };
+
+        int64_t sum = 0;
+        Signal<int> signal;
+        const auto allocations = allocationsOfRepeated([&] {
+            auto handle = signal.connect(LargeSlot{ &sum, {} });
+            handle.disconnect();
+        });
+        REQUIRE(allocations <= budget * s_repetitions);
+    }
+}
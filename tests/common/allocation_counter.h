@@ -0,0 +1,75 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#pragma once
+
+// Replaces the global operator new and delete with versions that count every allocation,
+// so tests can check that an operation doesn't allocate, or stays within an allocation budget.
+//
+// The replacement operators are defined out-of-line in allocation_counter.cpp, which must be
+// compiled into every test executable that includes this header. Keeping them out of the
+// test's translation unit stops the optimizer from pairing a new-expression with the
+// std::free inside the replacement operator delete (-Wmismatched-new-delete).
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace AllocationCounter {
+
+inline std::atomic<std::size_t> s_allocations{ 0 };
+
+inline void *allocate(std::size_t size)
+{
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+inline void *allocateAligned(std::size_t size, std::align_val_t alignment)
+{
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    const auto align = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+    return _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+    // std::aligned_alloc requires the size to be a multiple of the alignment.
+    return std::aligned_alloc(align, (size + align - 1) / align * align);
+#endif
+}
+
+inline void deallocateAligned(void *memory)
+{
+#ifdef _WIN32
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+// Counts the allocations that are made while it is alive.
+class Scope
+{
+public:
+    Scope()
+        : m_start(s_allocations.load(std::memory_order_relaxed))
+    {
+    }
+
+    std::size_t allocations() const
+    {
+        return s_allocations.load(std::memory_order_relaxed) - m_start;
+    }
+
+private:
+    std::size_t m_start;
+};
+
+} // namespace AllocationCounter
@@ -0,0 +1,207 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include <kdbindings/binding.h>
+#include <kdbindings/binding_evaluator.h>
+#include <kdbindings/connection_evaluator.h>
+#include <kdbindings/memory_resource.h>
+#include <kdbindings/node_operators.h>
+#include <kdbindings/property.h>
+#include <kdbindings/signal.h>
+
+#include <allocation_counter.h>
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+// The expansion of TEST_CASE from doctest leads to a clazy warning.
+// As this issue originates from doctest, disable the warning.
+// clazy:excludeall=non-pod-global-static
+
+using namespace KDBindings;
+
+// The memory resources of std::pmr are only needed by the tests, KDBindings itself provides
+// a replacement for pmr::memory_resource if the standard library doesn't have it.
+#if defined(__cpp_lib_memory_resource)
+
+namespace {
+
+// A monotonic arena that fails instead of falling back to the heap.
+class Arena
+{
+public:
+    Arena()
+        : m_resource(m_buffer.data(), m_buffer.size(), std::pmr::null_memory_resource())
+    {
+    }
+
+    std::pmr::memory_resource *resource() { return &m_resource; }
+
+private:
+    alignas(std::max_align_t) std::array<std::byte, 64 * 1024> m_buffer;
+    std::pmr::monotonic_buffer_resource m_resource;
+};
+
+// Counts the allocations that were not yet returned to an upstream memory resource.
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    explicit CountingResource(std::pmr::memory_resource *upstream)
+        : m_upstream(upstream)
+    {
+    }
+
+    std::size_t outstandingAllocations() const { return m_outstandingAllocations; }
+
+private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        auto *memory = m_upstream->allocate(bytes, alignment);
+        ++m_outstandingAllocations;
+        return memory;
+    }
+
+    void do_deallocate(void *memory, std::size_t bytes, std::size_t alignment) override
+    {
+        m_upstream->deallocate(memory, bytes, alignment);
+        --m_outstandingAllocations;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource *m_upstream;
+    std::size_t m_outstandingAllocations = 0;
+};
+
+// Too large to be stored inside a connection, so the Signal has to allocate it.
+struct LargeSlot {
+    void operator()(int value) const { *sum += value; }
+
+    int *sum;
+    std::array<char, 64> padding{};
+};
+
+} // namespace
+
+TEST_CASE("Memory resources")
+{
+    SUBCASE("A Signal allocates its connections from its memory resource")
+    {
+        Arena arena;
+        const AllocationCounter::Scope globalAllocations;
+        int sum = 0;
+        {
+            Signal<int> signal(arena.resource());
+            for (int i = 0; i < 100; ++i) {
+                (void)signal.connect([&sum](int value) { sum += value; });
+            }
+            auto handle = signal.connect(LargeSlot{ &sum });
+            (void)signal.connectReflective([&sum](ConnectionHandle &handle, int value) {
+                sum += value;
+                handle.disconnect();
+            });
+            (void)signal.connectBatch([&sum](const SignalBatch<int> &batch) { sum += static_cast<int>(batch.size()); });
+
+            signal.emit(1);
+            handle.disconnect();
+            signal.emit(1);
+            signal.disconnectAll();
+            (void)signal.connect([&sum](int value) { sum += value; });
+            signal.emit(1);
+        }
+        const auto allocations = globalAllocations.allocations();
+
+        REQUIRE(allocations == 0);
+        REQUIRE(sum == 103 + 101 + 1);
+    }
+
+    SUBCASE("A ConnectionEvaluator allocates its queued invocations from its memory resource")
+    {
+        Arena arena;
+        const AllocationCounter::Scope globalAllocations;
+        int sum = 0;
+        {
+            auto evaluator = std::allocate_shared<ConnectionEvaluator>(
+                    std::pmr::polymorphic_allocator<ConnectionEvaluator>(arena.resource()),
+                    arena.resource());
+            Signal<int> signal(arena.resource());
+            (void)signal.connectDeferred(evaluator, [&sum](int value) { sum += value; });
+
+            for (int i = 0; i < 10; ++i) {
+                signal.emit(i);
+            }
+            evaluator->evaluateDeferredConnections();
+        }
+        const auto allocations = globalAllocations.allocations();
+
+        REQUIRE(allocations == 0);
+        REQUIRE(sum == 45);
+    }
+
+    SUBCASE("Bindings are allocated from the memory resource they are created with")
+    {
+        Arena arena;
+        const AllocationCounter::Scope globalAllocations;
+        int result = 0;
+        {
+            BindingEvaluator evaluator(arena.resource());
+            Property<int> a(std::allocator_arg, arena.resource(), 1);
+            Property<int> b(std::allocator_arg, arena.resource(), 2);
+            auto sum = makeBoundProperty(std::allocator_arg, arena.resource(), evaluator, [](int a, int b) { return a + b * 2; }, a, b);
+            a = 3;
+            b = 4;
+            evaluator.evaluateAll();
+            result = sum.get();
+        }
+        const auto allocations = globalAllocations.allocations();
+
+        REQUIRE(allocations == 0);
+        REQUIRE(result == 11);
+    }
+
+    SUBCASE("Memory is returned to the memory resource it was allocated from")
+    {
+        std::pmr::unsynchronized_pool_resource pool;
+        CountingResource resource(&pool);
+        Property<int> source(5);
+
+        auto bound = std::make_unique<Property<int>>(makeBoundProperty(std::allocator_arg, &resource, std::plus<>(), source, 1));
+        REQUIRE(resource.outstandingAllocations() > 0);
+
+        source = 6;
+        REQUIRE(bound->get() == 7);
+        bound.reset();
+        REQUIRE(resource.outstandingAllocations() == 0);
+    }
+
+    SUBCASE("Nodes that are created before the Binding are not allocated from its memory resource")
+    {
+        CountingResource resource(std::pmr::new_delete_resource());
+        Property<int> source(5);
+        auto node = source + 1;
+
+        auto binding = makeBinding(std::allocator_arg, &resource, std::move(node));
+        REQUIRE(resource.outstandingAllocations() == 1);
+        REQUIRE(binding->get() == 6);
+        binding.reset();
+        REQUIRE(resource.outstandingAllocations() == 0);
+    }
+}
+
+#endif
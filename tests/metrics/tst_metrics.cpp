@@ -0,0 +1,232 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include <kdbindings/connection_evaluator.h>
+#include <kdbindings/metrics.h>
+#include <kdbindings/metrics_json.h>
+#include <kdbindings/signal.h>
+
+#ifndef KDBINDINGS_SINGLE_THREADED
+#include <kdbindings/lock_free_connection_evaluator.h>
+#endif
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+// The expansion of TEST_CASE from doctest leads to a clazy warning.
+// As this issue originates from doctest, disable the warning.
+// clazy:excludeall=non-pod-global-static
+
+using namespace KDBindings;
+
+static_assert(MetricsRegistry::isEnabled());
+
+namespace {
+
+std::optional<SignalMetrics> signalMetrics(const std::string &name)
+{
+    for (const auto &metrics : MetricsRegistry::instance().signalMetrics()) {
+        if (metrics.name == name) {
+            return metrics;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<ConnectionEvaluatorMetrics> evaluatorMetrics(const std::string &name)
+{
+    for (const auto &metrics : MetricsRegistry::instance().connectionEvaluatorMetrics()) {
+        if (metrics.name == name) {
+            return metrics;
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+TEST_CASE("Signal metrics")
+{
+    SUBCASE("Counts emits, slot invocations and blocked slots")
+    {
+        Signal<int> signal;
+        signal.setMetricsName("counted");
+        (void)signal.connect([](int) { });
+        auto blocked = signal.connect([](int) { });
+        (void)signal.connectBatch([](const SignalBatch<int> &) { });
+
+        signal.emit(1);
+        signal.blockConnection(blocked, true);
+        signal.emit(2);
+
+        auto metrics = signalMetrics("counted");
+        REQUIRE(metrics);
+        REQUIRE(metrics->emitCount == 2);
+        REQUIRE(metrics->slotInvocations == 5);
+        REQUIRE(metrics->blockedSkips == 1);
+        REQUIRE(metrics->maxFanOut == 3);
+    }
+
+    SUBCASE("Counts every value of an emitBatch as an emit")
+    {
+        Signal<int> signal;
+        signal.setMetricsName("batched");
+        (void)signal.connect([](int) { });
+        (void)signal.connectBatch([](const SignalBatch<int> &) { });
+
+        std::vector<std::tuple<int>> values{ { 1 }, { 2 }, { 3 } };
+        signal.emitBatch(values);
+
+        auto metrics = signalMetrics("batched");
+        REQUIRE(metrics);
+        REQUIRE(metrics->emitCount == 3);
+        REQUIRE(metrics->slotInvocations == 4);
+        // Both connections were called, the first one for every value.
+        REQUIRE(metrics->maxFanOut == 2);
+    }
+
+    SUBCASE("Measures the time spent in slots")
+    {
+        Signal<> signal;
+        signal.setMetricsName("timed");
+        (void)signal.connect([] { std::this_thread::sleep_for(std::chrono::milliseconds(2)); });
+        (void)signal.connect([] { });
+
+        signal.emit();
+        signal.emit();
+
+        auto metrics = signalMetrics("timed");
+        REQUIRE(metrics);
+        REQUIRE(metrics->maxSlotTime >= std::chrono::milliseconds(2));
+        REQUIRE(metrics->totalSlotTime >= std::chrono::milliseconds(4));
+        REQUIRE(metrics->totalSlotTime >= metrics->maxSlotTime);
+    }
+
+    SUBCASE("Keeps the metrics when all slots are disconnected")
+    {
+        Signal<> signal;
+        signal.setMetricsName("disconnected");
+        (void)signal.connect([] { });
+        signal.emit();
+        signal.disconnectAll();
+        signal.emit();
+
+        auto metrics = signalMetrics("disconnected");
+        REQUIRE(metrics);
+        REQUIRE(metrics->emitCount == 2);
+        REQUIRE(metrics->slotInvocations == 1);
+    }
+
+    SUBCASE("Signals are unregistered when they are destroyed")
+    {
+        {
+            Signal<> signal;
+            signal.setMetricsName("destroyed");
+            REQUIRE(signalMetrics("destroyed"));
+        }
+        REQUIRE_FALSE(signalMetrics("destroyed"));
+    }
+}
+
+TEST_CASE("ConnectionEvaluator metrics")
+{
+    auto evaluator = std::make_shared<ConnectionEvaluator>();
+    evaluator->setMetricsName("evaluator");
+    Signal<int> signal;
+    auto handle = signal.connectDeferred(evaluator, [](int) { });
+
+    signal.emit(1);
+    signal.emit(2);
+    signal.emit(3);
+
+    auto metrics = evaluatorMetrics("evaluator");
+    REQUIRE(metrics);
+    REQUIRE(metrics->queueDepth == 3);
+    REQUIRE(metrics->maxQueueDepth == 3);
+    REQUIRE(metrics->enqueuedInvocations == 3);
+
+    evaluator->evaluateDeferredConnections();
+    signal.emit(4);
+    handle.disconnect();
+
+    metrics = evaluatorMetrics("evaluator");
+    REQUIRE(metrics);
+    REQUIRE(metrics->queueDepth == 0);
+    REQUIRE(metrics->maxQueueDepth == 3);
+    REQUIRE(metrics->enqueuedInvocations == 4);
+    REQUIRE(metrics->evaluatedInvocations == 3);
+}
+
+#ifndef KDBINDINGS_SINGLE_THREADED
+TEST_CASE("LockFreeConnectionEvaluator metrics with multiple emitting threads")
+{
+    constexpr int threadCount = 4;
+    constexpr int emitsPerThread = 1000;
+
+    auto evaluator = std::make_shared<LockFreeConnectionEvaluator>(16, OverflowPolicy::Grow);
+    evaluator->setMetricsName("lock-free evaluator");
+    std::vector<std::unique_ptr<Signal<int>>> signals;
+    for (int i = 0; i < threadCount; ++i) {
+        signals.push_back(std::make_unique<Signal<int>>());
+        (void)signals.back()->connectDeferred(evaluator, [](int) { });
+    }
+
+    // Enqueues are recorded by every emitting thread without a lock, so none of them may get lost.
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; ++i) {
+        threads.emplace_back([&signal = *signals[i]]() {
+            for (int value = 0; value < emitsPerThread; ++value) {
+                signal.emit(value);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    evaluator->evaluateDeferredConnections();
+
+    const auto metrics = evaluatorMetrics("lock-free evaluator");
+    REQUIRE(metrics);
+    REQUIRE(metrics->enqueuedInvocations == threadCount * emitsPerThread);
+    REQUIRE(metrics->evaluatedInvocations == threadCount * emitsPerThread);
+    REQUIRE(metrics->maxQueueDepth <= threadCount * emitsPerThread);
+    REQUIRE(metrics->queueDepth == 0);
+}
+#endif
+
+TEST_CASE("writeMetricsJson")
+{
+    Signal<> signal;
+    signal.setMetricsName("json \"signal\"");
+    (void)signal.connect([] { });
+    signal.emit();
+
+    auto evaluator = std::make_shared<ConnectionEvaluator>();
+    evaluator->setMetricsName("json evaluator");
+
+    std::ostringstream stream;
+    writeMetricsJson(stream);
+    const auto json = stream.str();
+
+    REQUIRE(json.find("\"signals\": [") != std::string::npos);
+    REQUIRE(json.find("\"connectionEvaluators\": [") != std::string::npos);
+    REQUIRE(json.find("\"name\": \"json \\\"signal\\\"\", ") != std::string::npos);
+    REQUIRE(json.find("\"emitCount\": 1, \"slotInvocations\": 1") != std::string::npos);
+    REQUIRE(json.find("\"name\": \"json evaluator\"") != std::string::npos);
+}
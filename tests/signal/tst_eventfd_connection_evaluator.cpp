@@ -0,0 +1,211 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include <kdbindings/eventfd_connection_evaluator.h>
+#include <kdbindings/signal.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <doctest.h>
+
+// The expansion of TEST_CASE from doctest leads to a clazy warning.
+// As this issue originates from doctest, disable the warning.
+// clazy:excludeall=non-pod-global-static
+
+using namespace KDBindings;
+
+namespace {
+
+bool isReadable(int fd)
+{
+    pollfd pollFd{};
+    pollFd.fd = fd;
+    pollFd.events = POLLIN;
+    return ::poll(&pollFd, 1, 0) > 0;
+}
+
+// The value of the eventfd counter, which is the number of writes since it was last read.
+// Reading resets the eventfd, so this must only be called once per check.
+uint64_t readCounter(int fd)
+{
+    uint64_t value = 0;
+    if (::read(fd, &value, sizeof(value)) < 0) {
+        return 0;
+    }
+    return value;
+}
+
+} // namespace
+
+TEST_CASE("EventFdConnectionEvaluator")
+{
+    SUBCASE("The file descriptor becomes readable when an invocation is queued")
+    {
+        auto evaluator = std::make_shared<EventFdConnectionEvaluator>();
+        REQUIRE(evaluator->fileDescriptor() >= 0);
+        REQUIRE_FALSE(isReadable(evaluator->fileDescriptor()));
+
+        Signal<int> signal;
+        std::vector<int> values;
+        (void)signal.connectDeferred(evaluator, [&values](int value) { values.push_back(value); });
+
+        signal.emit(1);
+        REQUIRE(isReadable(evaluator->fileDescriptor()));
+        REQUIRE(values.empty());
+
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(values == std::vector<int>{ 1 });
+        REQUIRE_FALSE(isReadable(evaluator->fileDescriptor()));
+    }
+
+    SUBCASE("Many emits between evaluations only write to the eventfd once")
+    {
+        auto evaluator = std::make_shared<EventFdConnectionEvaluator>();
+        Signal<int> signal;
+        int sum = 0;
+        (void)signal.connectDeferred(evaluator, [&sum](int value) { sum += value; });
+        (void)signal.connectDeferred(evaluator, [&sum](int value) { sum += value; }, DeferredConnectionMode::Conflated);
+
+        for (int i = 1; i <= 100; ++i) {
+            signal.emit(i);
+        }
+        REQUIRE(readCounter(evaluator->fileDescriptor()) == 1);
+
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(sum == 5050 + 100);
+
+        // Once evaluated, the next emit writes to the eventfd again.
+        signal.emit(1);
+        REQUIRE(readCounter(evaluator->fileDescriptor()) == 1);
+    }
+
+    SUBCASE("A limited evaluation keeps the file descriptor readable while invocations are queued")
+    {
+        auto evaluator = std::make_shared<EventFdConnectionEvaluator>();
+        Signal<int> signal;
+        std::vector<int> values;
+        (void)signal.connectDeferred(evaluator, [&values](int value) { values.push_back(value); });
+
+        for (int i = 1; i <= 3; ++i) {
+            signal.emit(i);
+        }
+        REQUIRE(evaluator->evaluateDeferredConnections(2) == 1);
+        REQUIRE(isReadable(evaluator->fileDescriptor()));
+
+        REQUIRE(evaluator->evaluateDeferredConnections(2) == 0);
+        REQUIRE(values == std::vector<int>{ 1, 2, 3 });
+        REQUIRE_FALSE(isReadable(evaluator->fileDescriptor()));
+    }
+
+    SUBCASE("Invocations queued by a slot make the file descriptor readable again")
+    {
+        auto evaluator = std::make_shared<EventFdConnectionEvaluator>();
+        Signal<int> signal;
+        std::vector<int> values;
+        (void)signal.connectDeferred(evaluator, [&](int value) {
+            values.push_back(value);
+            if (value == 1) {
+                signal.emit(2);
+            }
+        });
+
+        signal.emit(1);
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(values == std::vector<int>{ 1 });
+        REQUIRE(isReadable(evaluator->fileDescriptor()));
+
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(values == std::vector<int>{ 1, 2 });
+        REQUIRE_FALSE(isReadable(evaluator->fileDescriptor()));
+    }
+
+    SUBCASE("An evaluation that finds nothing queued still resets the file descriptor")
+    {
+        auto evaluator = std::make_shared<EventFdConnectionEvaluator>();
+        Signal<int> signal;
+        std::vector<int> values;
+        (void)signal.connectDeferred(evaluator, [&values](int value) { values.push_back(value); });
+
+        signal.emit(1);
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(values == std::vector<int>{ 1 });
+
+        // Simulates the write of an emit on another thread that landed only after
+        // the evaluation had already reset the eventfd and evaluated its invocation.
+        const uint64_t value = 1;
+        REQUIRE(::write(evaluator->fileDescriptor(), &value, sizeof(value)) == sizeof(value));
+        REQUIRE(isReadable(evaluator->fileDescriptor()));
+
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(values == std::vector<int>{ 1 });
+        REQUIRE_FALSE(isReadable(evaluator->fileDescriptor()));
+
+        // Emitting afterwards still makes the file descriptor readable.
+        signal.emit(2);
+        REQUIRE(isReadable(evaluator->fileDescriptor()));
+    }
+
+    SUBCASE("A write that lands after the eventfd was reset doesn't leave it readable for good")
+    {
+        auto evaluator = std::make_shared<EventFdConnectionEvaluator>();
+        Signal<int> signal;
+        std::vector<int> values;
+        (void)signal.connectDeferred(evaluator, [&](int value) {
+            values.push_back(value);
+            // The evaluation already reset the eventfd, so this is like the write of an emit on
+            // another thread whose invocation was taken by this evaluation, but whose write came late.
+            const uint64_t one = 1;
+            REQUIRE(::write(evaluator->fileDescriptor(), &one, sizeof(one)) == sizeof(one));
+        });
+
+        signal.emit(1);
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(values == std::vector<int>{ 1 });
+        REQUIRE(isReadable(evaluator->fileDescriptor()));
+
+        // The event loop wakes up once more, and that evaluation resets the eventfd.
+        REQUIRE(evaluator->waitAndEvaluate(std::chrono::milliseconds(0)));
+        REQUIRE(values == std::vector<int>{ 1 });
+        REQUIRE_FALSE(isReadable(evaluator->fileDescriptor()));
+        REQUIRE_FALSE(evaluator->waitAndEvaluate(std::chrono::milliseconds(0)));
+    }
+
+    SUBCASE("waitAndEvaluate times out if nothing is queued")
+    {
+        auto evaluator = std::make_shared<EventFdConnectionEvaluator>();
+        REQUIRE_FALSE(evaluator->waitAndEvaluate(std::chrono::milliseconds(0)));
+        REQUIRE_FALSE(evaluator->waitAndEvaluate(std::chrono::milliseconds(10)));
+    }
+
+    SUBCASE("waitAndEvaluate evaluates invocations that are queued on another thread")
+    {
+        auto evaluator = std::make_shared<EventFdConnectionEvaluator>();
+        Signal<int> signal;
+        std::vector<int> values;
+        (void)signal.connectDeferred(evaluator, [&values](int value) { values.push_back(value); });
+
+        std::thread emittingThread([&signal]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            signal.emit(1);
+        });
+        const bool evaluated = evaluator->waitAndEvaluate(std::chrono::seconds(10));
+        emittingThread.join();
+
+        REQUIRE(evaluated);
+        REQUIRE(values == std::vector<int>{ 1 });
+    }
+}
@@ -0,0 +1,265 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include <kdbindings/lock_free_connection_evaluator.h>
+#include <kdbindings/signal.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <doctest.h>
+
+// The expansion of TEST_CASE from doctest leads to a clazy warning.
+// As this issue originates from doctest, disable the warning.
+// clazy:excludeall=non-pod-global-static
+
+using namespace KDBindings;
+
+TEST_CASE("LockFreeConnectionEvaluator")
+{
+    SUBCASE("Evaluates the queued invocations in order")
+    {
+        auto evaluator = std::make_shared<LockFreeConnectionEvaluator>();
+        Signal<int> signal;
+        std::vector<int> values;
+        (void)signal.connectDeferred(evaluator, [&values](int value) { values.push_back(value); });
+
+        signal.emit(1);
+        signal.emit(2);
+        signal.emit(3);
+        REQUIRE(values.empty());
+
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(values == std::vector<int>{ 1, 2, 3 });
+
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(values.size() == 3);
+    }
+
+    SUBCASE("The capacity is rounded up to a power of two")
+    {
+        REQUIRE(LockFreeConnectionEvaluator(5).capacity() == 8);
+        REQUIRE(LockFreeConnectionEvaluator(8).capacity() == 8);
+        REQUIRE(LockFreeConnectionEvaluator().capacity() == LockFreeConnectionEvaluator::DefaultCapacity);
+    }
+
+    SUBCASE("Skips the invocations of disconnected connections")
+    {
+        auto evaluator = std::make_shared<LockFreeConnectionEvaluator>();
+        Signal<int> signal;
+        int sum = 0;
+        auto handle = signal.connectDeferred(evaluator, [&sum](int value) { sum += value; });
+        (void)signal.connectDeferred(evaluator, [&sum](int value) { sum += 10 * value; });
+
+        signal.emit(1);
+        handle.disconnect();
+        signal.emit(2);
+
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(sum == 30);
+    }
+
+    SUBCASE("DropNewest discards invocations while the queue is full")
+    {
+        auto evaluator = std::make_shared<LockFreeConnectionEvaluator>(2, OverflowPolicy::DropNewest);
+        Signal<int> signal;
+        std::vector<int> values;
+        (void)signal.connectDeferred(evaluator, [&values](int value) { values.push_back(value); });
+
+        for (int i = 1; i <= 4; ++i) {
+            signal.emit(i);
+        }
+        REQUIRE(evaluator->droppedInvocations() == 2);
+
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(values == std::vector<int>{ 1, 2 });
+    }
+
+    SUBCASE("DropOldest discards the oldest invocations while the queue is full")
+    {
+        auto evaluator = std::make_shared<LockFreeConnectionEvaluator>(2, OverflowPolicy::DropOldest);
+        Signal<int> signal;
+        std::vector<int> values;
+        (void)signal.connectDeferred(evaluator, [&values](int value) { values.push_back(value); });
+
+        for (int i = 1; i <= 4; ++i) {
+            signal.emit(i);
+        }
+        REQUIRE(evaluator->droppedInvocations() == 2);
+
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(values == std::vector<int>{ 3, 4 });
+    }
+
+    SUBCASE("DropOldest doesn't lose a conflated connection whose invocation was dropped")
+    {
+        auto evaluator = std::make_shared<LockFreeConnectionEvaluator>(2, OverflowPolicy::DropOldest);
+        Signal<int> signal;
+        std::vector<int> conflatedValues;
+        (void)signal.connectDeferred(evaluator, [&conflatedValues](int value) { conflatedValues.push_back(value); }, DeferredConnectionMode::Conflated);
+        (void)signal.connectDeferred(evaluator, [](int) {});
+
+        // The placeholder of the conflated connection is dropped.
+        signal.emit(1);
+        signal.emit(2);
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(conflatedValues.empty());
+
+        signal.emit(3);
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(conflatedValues == std::vector<int>{ 3 });
+    }
+
+    SUBCASE("A conflated connection only evaluates the latest emit")
+    {
+        auto evaluator = std::make_shared<LockFreeConnectionEvaluator>(2, OverflowPolicy::DropNewest);
+        Signal<int> signal;
+        std::vector<int> values;
+        (void)signal.connectDeferred(evaluator, [&values](int value) { values.push_back(value); }, DeferredConnectionMode::Conflated);
+
+        // Only uses a single cell of the queue, so nothing is dropped.
+        for (int i = 1; i <= 10; ++i) {
+            signal.emit(i);
+        }
+        REQUIRE(evaluator->droppedInvocations() == 0);
+
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(values == std::vector<int>{ 10 });
+    }
+
+    SUBCASE("Grow keeps all invocations in order")
+    {
+        auto evaluator = std::make_shared<LockFreeConnectionEvaluator>(2, OverflowPolicy::Grow);
+        Signal<int> signal;
+        std::vector<int> values;
+        (void)signal.connectDeferred(evaluator, [&values](int value) { values.push_back(value); });
+
+        for (int i = 1; i <= 5; ++i) {
+            signal.emit(i);
+        }
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(values == std::vector<int>{ 1, 2, 3, 4, 5 });
+        REQUIRE(evaluator->droppedInvocations() == 0);
+
+        // Once the overflow list was evaluated, the ring buffer is used again.
+        signal.emit(6);
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(values.back() == 6);
+    }
+
+    SUBCASE("Evaluating a limited number of invocations keeps the rest queued in order")
+    {
+        auto evaluator = std::make_shared<LockFreeConnectionEvaluator>(2, OverflowPolicy::Grow);
+        Signal<int> signal;
+        std::vector<int> values;
+        (void)signal.connectDeferred(evaluator, [&values](int value) { values.push_back(value); });
+
+        // 1 and 2 are stored in the ring buffer, the others in the overflow list.
+        for (int i = 1; i <= 5; ++i) {
+            signal.emit(i);
+        }
+        REQUIRE(evaluator->evaluateDeferredConnections(3) == 2);
+        REQUIRE(values == std::vector<int>{ 1, 2, 3 });
+
+        // Queued into the ring buffer, but newer than the rest of the overflow list.
+        signal.emit(6);
+        REQUIRE(evaluator->evaluateDeferredConnections(1) == 2);
+        REQUIRE(values == std::vector<int>{ 1, 2, 3, 4 });
+
+        REQUIRE(evaluator->evaluateFor(std::chrono::seconds(10)) == 0);
+        REQUIRE(values == std::vector<int>{ 1, 2, 3, 4, 5, 6 });
+    }
+
+    SUBCASE("Block doesn't wait forever if a slot emits into the full queue")
+    {
+        auto evaluator = std::make_shared<LockFreeConnectionEvaluator>(2, OverflowPolicy::Block);
+        Signal<int> signal;
+        std::vector<int> values;
+        (void)signal.connectDeferred(evaluator, [&](int value) {
+            values.push_back(value);
+            if (value == 1) {
+                for (int i = 10; i < 13; ++i) {
+                    signal.emit(i);
+                }
+            }
+        });
+
+        signal.emit(1);
+        evaluator->evaluateDeferredConnections();
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(values == std::vector<int>{ 1, 10, 11, 12 });
+    }
+
+    SUBCASE("Emitting doesn't wait for slots that are being evaluated")
+    {
+        auto evaluator = std::make_shared<LockFreeConnectionEvaluator>();
+        Signal<int> signal;
+        std::atomic<bool> slotRunning{ false };
+        std::atomic<bool> emitted{ false };
+        (void)signal.connectDeferred(evaluator, [&](int value) {
+            if (value == 1) {
+                slotRunning = true;
+                while (!emitted.load()) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        signal.emit(1);
+        std::thread evaluatingThread([&evaluator]() { evaluator->evaluateDeferredConnections(); });
+        while (!slotRunning.load()) {
+            std::this_thread::yield();
+        }
+        // Would never return if emitting had to wait for the running slot.
+        signal.emit(2);
+        emitted = true;
+        evaluatingThread.join();
+    }
+
+    SUBCASE("Can emit on multiple threads while another thread evaluates")
+    {
+        constexpr int threadCount = 4;
+        constexpr int emitsPerThread = 10000;
+
+        for (auto policy : { OverflowPolicy::Block, OverflowPolicy::Grow }) {
+            auto evaluator = std::make_shared<LockFreeConnectionEvaluator>(64, policy);
+            std::vector<Signal<int>> signals(threadCount);
+            int64_t sum = 0;
+            for (auto &signal : signals) {
+                (void)signal.connectDeferred(evaluator, [&sum](int value) { sum += value; });
+            }
+
+            std::atomic<int> runningProducers{ threadCount };
+            std::vector<std::thread> producers;
+            for (int t = 0; t < threadCount; ++t) {
+                producers.emplace_back([&, t]() {
+                    for (int i = 0; i < emitsPerThread; ++i) {
+                        signals[t].emit(1);
+                    }
+                    --runningProducers;
+                });
+            }
+            while (runningProducers.load() > 0) {
+                evaluator->evaluateDeferredConnections();
+            }
+            for (auto &producer : producers) {
+                producer.join();
+            }
+            evaluator->evaluateDeferredConnections();
+            evaluator->evaluateDeferredConnections();
+
+            REQUIRE(sum == int64_t(threadCount) * emitsPerThread);
+        }
+    }
+}
@@ -0,0 +1,233 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include <kdbindings/parallel_connection_evaluator.h>
+#include <kdbindings/signal.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <doctest.h>
+
+// The expansion of TEST_CASE from doctest leads to a clazy warning.
+// As this issue originates from doctest, disable the warning.
+// clazy:excludeall=non-pod-global-static
+
+using namespace KDBindings;
+
+TEST_CASE("ParallelConnectionEvaluator")
+{
+    SUBCASE("Evaluates the invocations of each connection in order")
+    {
+        constexpr int connectionCount = 8;
+        constexpr int emitCount = 100;
+
+        auto evaluator = std::make_shared<ParallelConnectionEvaluator>(3);
+        REQUIRE(evaluator->threadCount() == 3);
+
+        Signal<int> signal;
+        std::vector<std::vector<int>> values(connectionCount);
+        for (auto &connectionValues : values) {
+            (void)signal.connectDeferred(evaluator, [&connectionValues](int value) { connectionValues.push_back(value); });
+        }
+
+        for (int i = 0; i < emitCount; ++i) {
+            signal.emit(i);
+        }
+        evaluator->evaluateDeferredConnections();
+
+        std::vector<int> expected;
+        for (int i = 0; i < emitCount; ++i) {
+            expected.push_back(i);
+        }
+        for (const auto &connectionValues : values) {
+            REQUIRE(connectionValues == expected);
+        }
+
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(values[0].size() == emitCount);
+    }
+
+    SUBCASE("Evaluates different connections in parallel")
+    {
+        // Each slot waits for the other one to start, which only finishes if they run at the same time.
+        auto evaluator = std::make_shared<ParallelConnectionEvaluator>(1);
+        Signal<> signal;
+        std::atomic<int> started{ 0 };
+        for (int i = 0; i < 2; ++i) {
+            (void)signal.connectDeferred(evaluator, [&started]() {
+                ++started;
+                while (started.load() < 2) {
+                    std::this_thread::yield();
+                }
+            });
+        }
+
+        signal.emit();
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(started == 2);
+    }
+
+    SUBCASE("Skips the invocations of disconnected connections")
+    {
+        auto evaluator = std::make_shared<ParallelConnectionEvaluator>(2);
+        Signal<int> signal;
+        std::mutex mutex;
+        int sum = 0;
+        auto handle = signal.connectDeferred(evaluator, [&](int value) {
+            std::lock_guard<std::mutex> lock(mutex);
+            sum += value;
+        });
+        (void)signal.connectDeferred(evaluator, [&](int value) {
+            std::lock_guard<std::mutex> lock(mutex);
+            sum += 10 * value;
+        });
+
+        signal.emit(1);
+        handle.disconnect();
+        signal.emit(2);
+
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(sum == 30);
+    }
+
+    SUBCASE("Evaluating a limited number of invocations keeps the rest queued in order")
+    {
+        auto evaluator = std::make_shared<ParallelConnectionEvaluator>(2);
+        Signal<int> signal;
+        std::vector<int> values;
+        (void)signal.connectDeferred(evaluator, [&values](int value) { values.push_back(value); });
+
+        for (int i = 1; i <= 5; ++i) {
+            signal.emit(i);
+        }
+        REQUIRE(evaluator->evaluateDeferredConnections(2) == 3);
+        REQUIRE(values == std::vector<int>{ 1, 2 });
+
+        signal.emit(6);
+        REQUIRE(evaluator->evaluateDeferredConnections(2) == 2);
+        REQUIRE(values == std::vector<int>{ 1, 2, 3, 4 });
+
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(values == std::vector<int>{ 1, 2, 3, 4, 5, 6 });
+    }
+
+    SUBCASE("Evaluating for a limited time keeps the rest queued in order")
+    {
+        auto evaluator = std::make_shared<ParallelConnectionEvaluator>(2);
+        Signal<int> signal;
+        std::vector<std::vector<int>> values(2);
+        for (auto &connectionValues : values) {
+            (void)signal.connectDeferred(evaluator, [&connectionValues](int value) {
+                connectionValues.push_back(value);
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            });
+        }
+
+        for (int i = 1; i <= 3; ++i) {
+            signal.emit(i);
+        }
+        // Every slot exceeds the time budget, so each connection evaluates at most its first invocation.
+        const auto remaining = evaluator->evaluateFor(std::chrono::milliseconds(10));
+        REQUIRE(values[0].size() <= 1);
+        REQUIRE(values[1].size() <= 1);
+        REQUIRE(remaining == 6 - values[0].size() - values[1].size());
+
+        signal.emit(4);
+        REQUIRE(evaluator->evaluateFor(std::chrono::seconds(10)) == 0);
+        REQUIRE(values[0] == std::vector<int>{ 1, 2, 3, 4 });
+        REQUIRE(values[1] == std::vector<int>{ 1, 2, 3, 4 });
+    }
+
+    SUBCASE("A limited evaluation takes the highest priority invocations")
+    {
+        auto evaluator = std::make_shared<ParallelConnectionEvaluator>(2);
+        Signal<int> signal;
+        std::atomic<int> lowCalls{ 0 };
+        std::atomic<int> highCalls{ 0 };
+        (void)signal.connectDeferred(evaluator, [&lowCalls](int) { ++lowCalls; }, DeferredConnectionPriority::Low);
+        (void)signal.connectDeferred(evaluator, [&highCalls](int) { ++highCalls; }, DeferredConnectionPriority::High);
+
+        signal.emit(1);
+        signal.emit(2);
+        REQUIRE(evaluator->evaluateDeferredConnections(2) == 2);
+        REQUIRE(highCalls == 2);
+        REQUIRE(lowCalls == 0);
+
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(lowCalls == 2);
+    }
+
+    SUBCASE("A conflated connection only evaluates the latest emit")
+    {
+        auto evaluator = std::make_shared<ParallelConnectionEvaluator>(2);
+        Signal<int> signal;
+        std::vector<int> values;
+        (void)signal.connectDeferred(evaluator, [&values](int value) { values.push_back(value); }, DeferredConnectionMode::Conflated);
+
+        for (int i = 1; i <= 10; ++i) {
+            signal.emit(i);
+        }
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(values == std::vector<int>{ 10 });
+
+        signal.emit(11);
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(values == std::vector<int>{ 10, 11 });
+    }
+
+    SUBCASE("Slots can emit and evaluate while being evaluated")
+    {
+        auto evaluator = std::make_shared<ParallelConnectionEvaluator>(2);
+        Signal<int> signal;
+        std::atomic<int> sum{ 0 };
+        (void)signal.connectDeferred(evaluator, [&](int value) {
+            sum += value;
+            if (value == 1) {
+                evaluator->evaluateDeferredConnections(); // Does nothing
+                signal.emit(2);
+            }
+        });
+
+        signal.emit(1);
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(sum == 1);
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(sum == 3);
+    }
+
+    SUBCASE("Rethrows the exception of a slot once the other invocations are evaluated")
+    {
+        auto evaluator = std::make_shared<ParallelConnectionEvaluator>(2);
+        Signal<int> signal;
+        std::atomic<int> otherCalls{ 0 };
+        std::atomic<int> throwingCalls{ 0 };
+        (void)signal.connectDeferred(evaluator, [&](int) {
+            ++throwingCalls;
+            throw std::runtime_error("Slot failed");
+        });
+        (void)signal.connectDeferred(evaluator, [&](int) { ++otherCalls; });
+
+        signal.emit(1);
+        signal.emit(2);
+        REQUIRE_THROWS_AS(evaluator->evaluateDeferredConnections(), std::runtime_error);
+        REQUIRE(throwingCalls == 1);
+        REQUIRE(otherCalls == 2);
+
+        // The evaluator can still be used afterwards.
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(otherCalls == 2);
+    }
+}
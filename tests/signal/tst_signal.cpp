@@ -13,9 +13,14 @@
 #include <kdbindings/signal.h>
 #include <kdbindings/connection_evaluator.h>
 
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <thread>
+#include <tuple>
+#include <vector>
 
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest.h>
@@ -64,6 +69,26 @@ public:
     bool handlerCalled = false;
 };
 
+// Counts how often instances of this class were copied.
+class CopyCounter
+{
+public:
+    CopyCounter() = default;
+    CopyCounter(const CopyCounter &other)
+        : copies(other.copies)
+    {
+        ++*copies;
+    }
+    CopyCounter &operator=(const CopyCounter &other)
+    {
+        copies = other.copies;
+        ++*copies;
+        return *this;
+    }
+
+    std::shared_ptr<int> copies = std::make_shared<int>(0);
+};
+
 class CallbackCounter
 {
 public:
@@ -203,6 +228,35 @@ TEST_CASE("Signal connections")
         REQUIRE(lambdaCallCount2 == 2);
     }
 
+    SUBCASE("Slots are called in the order in which they were connected, even after disconnects")
+    {
+        Signal<> signal;
+        std::vector<int> calls;
+        std::vector<ConnectionHandle> handles;
+        for (int i = 1; i <= 5; ++i) {
+            handles.push_back(signal.connect([&calls, i]() { calls.push_back(i); }));
+        }
+
+        handles[1].disconnect();
+        signal.emit();
+        REQUIRE(calls == std::vector<int>{ 1, 3, 4, 5 });
+
+        // A slot that disconnects another one during an emit.
+        calls.clear();
+        (void)signal.connect([&]() {
+            calls.push_back(6);
+            handles[2].disconnect();
+        });
+        (void)signal.connect([&calls]() { calls.push_back(7); });
+        signal.emit();
+        REQUIRE(calls == std::vector<int>{ 1, 3, 4, 5, 6, 7 });
+
+        calls.clear();
+        handles[0].disconnect();
+        signal.emit();
+        REQUIRE(calls == std::vector<int>{ 4, 5, 6, 7 });
+    }
+
     SUBCASE("A signal can be disconnected inside a slot")
     {
         Signal<> signal;
@@ -253,6 +307,67 @@ TEST_CASE("Signal connections")
         REQUIRE(lambdaCallCount2 == 1);
     }
 
+    SUBCASE("A signal can be connected to a move-only lambda")
+    {
+        Signal<int> signal;
+        auto value = std::make_unique<int>(0);
+        int *valuePtr = value.get();
+
+        (void)signal.connect([value = std::move(value)](int newValue) { *value = newValue; });
+        signal.emit(42);
+
+        REQUIRE(*valuePtr == 42);
+    }
+
+    SUBCASE("Connecting an empty std::function does not call anything")
+    {
+        Signal<int> signal;
+        const auto handle = signal.connect(std::function<void(int)>{});
+
+        REQUIRE(handle.isActive());
+        REQUIRE_NOTHROW(signal.emit(42));
+    }
+
+    SUBCASE("Emitting does not copy arguments for slots taking const references")
+    {
+        Signal<CopyCounter> signal;
+        int called = 0;
+        for (int i = 0; i < 3; ++i) {
+            (void)signal.connect([&called](const CopyCounter &) { ++called; });
+        }
+        (void)signal.connectReflective([&called](ConnectionHandle &, const CopyCounter &) { ++called; });
+
+        const CopyCounter counter;
+        signal.emit(counter);
+
+        REQUIRE(called == 4);
+        REQUIRE(*counter.copies == 0);
+    }
+
+    SUBCASE("Emitting copies arguments only for slots taking them by value")
+    {
+        Signal<CopyCounter> signal;
+        (void)signal.connect([](const CopyCounter &) {});
+        (void)signal.connect([](CopyCounter) {});
+
+        const CopyCounter counter;
+        signal.emit(counter);
+
+        REQUIRE(*counter.copies == 1);
+    }
+
+    SUBCASE("A signal with a non-const reference argument can modify the argument")
+    {
+        Signal<int &> signal;
+        (void)signal.connect([](int &value) { value += 1; });
+        (void)signal.connect([](int &value) { value *= 2; });
+
+        int value = 1;
+        signal.emit(value);
+
+        REQUIRE(value == 4);
+    }
+
     SUBCASE("A signal can be connected via a non-const reference to it")
     {
         Signal<int> s;
@@ -324,6 +439,32 @@ TEST_CASE("Signal connections")
         REQUIRE(lambdaCalled == true);
     }
 
+    SUBCASE("A reflective slot can keep a copy of its ConnectionHandle")
+    {
+        ConnectionHandle copied;
+        ConnectionHandle moved;
+        {
+            Signal<int> signal;
+            auto handle = signal.connectReflective([&](ConnectionHandle &slotHandle, int) {
+                copied = slotHandle;
+                ConnectionHandle temporary(slotHandle);
+                moved = std::move(temporary);
+            });
+            signal.emit(1);
+
+            REQUIRE(copied.isActive());
+            REQUIRE(copied.belongsTo(signal));
+            REQUIRE(copied == handle);
+            REQUIRE(moved == handle);
+
+            copied.block(true);
+            REQUIRE(handle.isBlocked());
+        }
+        // The copies own a weak reference to the Signal, so they notice that it's gone.
+        REQUIRE_FALSE(copied.isActive());
+        REQUIRE_FALSE(moved.isActive());
+    }
+
     SUBCASE("A reflective connection cannot deconstruct itself while still in use")
     {
         class DestructorNotifier
@@ -370,6 +511,313 @@ TEST_CASE("Signal connections")
     }
 }
 
+TEST_CASE("Nested emits")
+{
+    SUBCASE("A slot can emit the signal it is connected to")
+    {
+        Signal<int> signal;
+        std::vector<int> values;
+        (void)signal.connect([&](int value) {
+            values.push_back(value);
+            if (value > 0) {
+                signal.emit(value - 1);
+            }
+        });
+        (void)signal.connect([&](int value) { values.push_back(value * 10); });
+
+        signal.emit(2);
+        REQUIRE(values == std::vector<int>{ 2, 1, 0, 0, 10, 20 });
+    }
+
+    SUBCASE("A slot disconnected during an emit is no longer called by nested emits")
+    {
+        Signal<int> signal;
+        int secondCalls = 0;
+        ConnectionHandle second;
+
+        (void)signal.connect([&](int value) {
+            if (value == 1) {
+                second.disconnect();
+                REQUIRE_FALSE(second.isActive());
+                signal.emit(0);
+            }
+        });
+        second = signal.connect([&](int) { ++secondCalls; });
+
+        signal.emit(1);
+        REQUIRE(secondCalls == 0);
+        REQUIRE_FALSE(second.isActive());
+    }
+
+    SUBCASE("A connection disconnected during an emit is inactive right away")
+    {
+        Signal<> signal;
+        ConnectionHandle second;
+        bool activeDuringEmit = true;
+
+        (void)signal.connect([&]() {
+            // Disconnect with a copy, so that `second` itself still refers to the connection.
+            ConnectionHandle copy = second;
+            copy.disconnect();
+            activeDuringEmit = second.isActive();
+        });
+        second = signal.connect([]() {});
+        REQUIRE(second.isActive());
+
+        signal.emit();
+        REQUIRE_FALSE(activeDuringEmit);
+        REQUIRE_FALSE(second.isActive());
+    }
+
+    SUBCASE("A slot connected during an emit is called once the outermost emit is done")
+    {
+        Signal<int> signal;
+        std::vector<int> newSlotValues;
+        ConnectionHandle newHandle;
+        bool connected = false;
+
+        (void)signal.connect([&](int value) {
+            if (!connected) {
+                connected = true;
+                // Connect enough slots to force the connection storage to grow.
+                for (int i = 0; i < 16; ++i) {
+                    (void)signal.connect([](int) {});
+                }
+                newHandle = signal.connect([&](int value) { newSlotValues.push_back(value); });
+                REQUIRE(newHandle.isActive());
+                REQUIRE_FALSE(newHandle.block(true));
+                REQUIRE(newHandle.block(false));
+            }
+            if (value > 0) {
+                signal.emit(value - 1);
+            }
+        });
+
+        signal.emit(1);
+        REQUIRE(newSlotValues.empty());
+        REQUIRE(newHandle.isActive());
+
+        signal.emit(0);
+        REQUIRE(newSlotValues == std::vector<int>{ 0 });
+    }
+
+    SUBCASE("A slot connected and disconnected during an emit is never called")
+    {
+        Signal<> signal;
+        int calls = 0;
+        ConnectionHandle newHandle;
+
+        auto handle = signal.connect([&]() {
+            newHandle = signal.connect([&calls]() { ++calls; });
+            newHandle.disconnect();
+            REQUIRE_FALSE(newHandle.isActive());
+        });
+
+        signal.emit();
+        handle.disconnect();
+        signal.emit();
+        REQUIRE(calls == 0);
+        REQUIRE_FALSE(newHandle.isActive());
+    }
+
+    SUBCASE("disconnectAll during an emit also disconnects slots connected during the emit")
+    {
+        Signal<> signal;
+        int calls = 0;
+        ConnectionHandle newHandle;
+
+        (void)signal.connect([&]() {
+            newHandle = signal.connect([&calls]() { ++calls; });
+            signal.disconnectAll();
+        });
+        (void)signal.connect([&calls]() { ++calls; });
+
+        signal.emit();
+        signal.emit();
+        REQUIRE(calls == 0);
+        REQUIRE_FALSE(newHandle.isActive());
+    }
+
+    SUBCASE("disconnectAll copes with slots whose destructor disconnects other slots")
+    {
+        // Runs an action when the slot is destroyed, but not when a moved-from copy is destroyed.
+        struct DisconnectOnDestruction {
+            void operator()() const { }
+            ~DisconnectOnDestruction()
+            {
+                if (token) {
+                    other->disconnect();
+                }
+            }
+            DisconnectOnDestruction(ConnectionHandle *handle)
+                : other(handle), token(std::make_unique<int>())
+            {
+            }
+            DisconnectOnDestruction(DisconnectOnDestruction &&) = default;
+
+            ConnectionHandle *other;
+            std::unique_ptr<int> token;
+        };
+
+        Signal<> signal;
+        int calls = 0;
+        std::vector<ConnectionHandle> handles(10);
+        for (std::size_t i = 0; i < handles.size(); ++i) {
+            if (i % 2 == 0) {
+                handles[i] = signal.connect(DisconnectOnDestruction(&handles[(i + 5) % handles.size()]));
+            } else {
+                handles[i] = signal.connect([&calls]() { ++calls; });
+            }
+        }
+
+        signal.disconnectAll();
+        for (const auto &handle : handles) {
+            REQUIRE_FALSE(handle.isActive());
+        }
+
+        signal.emit();
+        REQUIRE(calls == 0);
+
+        (void)signal.connect([&calls]() { ++calls; });
+        signal.emit();
+        REQUIRE(calls == 1);
+    }
+
+    SUBCASE("Slots disconnected during an emit are removed once it is done")
+    {
+        Signal<int> signal;
+        int calls = 0;
+        std::vector<ConnectionHandle> handles;
+        for (int i = 0; i < 100; ++i) {
+            handles.push_back(signal.connect([&calls](int) { ++calls; }));
+        }
+        (void)signal.connectSingleShot([&](int) {
+            handles[10].disconnect();
+            handles[20].disconnect();
+            handles[20].disconnect();
+        });
+
+        signal.emit(0);
+        REQUIRE_FALSE(handles[10].isActive());
+        REQUIRE_FALSE(handles[20].isActive());
+
+        calls = 0;
+        signal.emit(0);
+        REQUIRE(calls == 98);
+    }
+
+    SUBCASE("Changes made during an emit are applied if a slot throws")
+    {
+        Signal<> signal;
+        int calls = 0;
+        ConnectionHandle throwing;
+
+        throwing = signal.connect([&]() {
+            throwing.disconnect();
+            (void)signal.connect([&calls]() { ++calls; });
+            throw std::runtime_error("slot failed");
+        });
+
+        REQUIRE_THROWS_AS(signal.emit(), std::runtime_error);
+        REQUIRE_FALSE(throwing.isActive());
+
+        signal.emit();
+        REQUIRE(calls == 1);
+    }
+}
+
+TEST_CASE("Batch emission")
+{
+    SUBCASE("emitBatch calls every slot for every element in order")
+    {
+        Signal<int, float> signal;
+        std::vector<std::pair<int, float>> first;
+        std::vector<int> second;
+        (void)signal.connect([&first](int i, float f) { first.emplace_back(i, f); });
+        (void)signal.connect([&second](int i) { second.push_back(i); });
+
+        const std::vector<std::tuple<int, float>> batch{ { 1, 0.5f }, { 2, 1.5f }, { 3, 2.5f } };
+        signal.emitBatch(batch);
+
+        REQUIRE(first == std::vector<std::pair<int, float>>{ { 1, 0.5f }, { 2, 1.5f }, { 3, 2.5f } });
+        REQUIRE(second == std::vector<int>{ 1, 2, 3 });
+    }
+
+    SUBCASE("emitBatch accepts a pointer and a size")
+    {
+        Signal<int> signal;
+        int sum = 0;
+        (void)signal.connect([&sum](int value) { sum += value; });
+
+        const std::tuple<int> values[] = { { 1 }, { 2 }, { 3 }, { 4 } };
+        signal.emitBatch({ values, 2 });
+        REQUIRE(sum == 3);
+
+        signal.emitBatch({ values, 0 });
+        REQUIRE(sum == 3);
+    }
+
+    SUBCASE("A batch slot receives the whole batch at once")
+    {
+        Signal<int> signal;
+        std::vector<size_t> batchSizes;
+        int sum = 0;
+        (void)signal.connectBatch([&](const SignalBatch<int> &batch) {
+            batchSizes.push_back(batch.size());
+            for (const auto &[value] : batch) {
+                sum += value;
+            }
+        });
+
+        const std::vector<std::tuple<int>> batch{ { 1 }, { 2 }, { 3 } };
+        signal.emitBatch(batch);
+        signal.emit(10);
+
+        REQUIRE(batchSizes == std::vector<size_t>{ 3, 1 });
+        REQUIRE(sum == 16);
+    }
+
+    SUBCASE("Blocked batch slots are not called")
+    {
+        Signal<int> signal;
+        int calls = 0;
+        auto handle = signal.connectBatch([&calls](const SignalBatch<int> &) { ++calls; });
+        handle.block(true);
+
+        signal.emit(1);
+        signal.emitBatch(std::vector<std::tuple<int>>{ { 1 } });
+        REQUIRE(calls == 0);
+
+        handle.disconnect();
+        REQUIRE_FALSE(handle.isActive());
+    }
+
+    SUBCASE("A slot that disconnects itself does not receive the rest of the batch")
+    {
+        Signal<int> signal;
+        std::vector<int> values;
+        (void)signal.connectReflective([&values](ConnectionHandle &handle, int value) {
+            values.push_back(value);
+            if (value == 2) {
+                handle.disconnect();
+            }
+        });
+
+        signal.emitBatch(std::vector<std::tuple<int>>{ { 1 }, { 2 }, { 3 } });
+        REQUIRE(values == std::vector<int>{ 1, 2 });
+    }
+
+    SUBCASE("Single shot connections only receive the first element")
+    {
+        Signal<int> signal;
+        std::vector<int> values;
+        (void)signal.connectSingleShot([&values](int value) { values.push_back(value); });
+
+        signal.emitBatch(std::vector<std::tuple<int>>{ { 1 }, { 2 } });
+        REQUIRE(values == std::vector<int>{ 1 });
+    }
+}
+
 TEST_CASE("ConnectionEvaluator")
 {
     SUBCASE("Disconnect Deferred Connection")
@@ -405,6 +853,8 @@ TEST_CASE("ConnectionEvaluator")
         REQUIRE(val == 9);
     }
 
+#ifndef KDBINDINGS_SINGLE_THREADED
+    // Signals must not be shared between threads in single-threaded builds.
     SUBCASE("Multiple Signals with Evaluator")
     {
         Signal<int> signal1;
@@ -435,7 +885,32 @@ TEST_CASE("ConnectionEvaluator")
 
         REQUIRE(val == 9);
     }
+#endif
+
+    SUBCASE("disconnectAll only removes the queued invocations of its own Signal")
+    {
+        Signal<int> signal1;
+        Signal<int> signal2;
+        int val1 = 0;
+        int val2 = 0;
+        auto evaluator = std::make_shared<ConnectionEvaluator>();
+
+        for (int i = 0; i < 3; ++i) {
+            (void)signal1.connectDeferred(evaluator, [&val1](int value) { val1 += value; });
+        }
+        (void)signal2.connectDeferred(evaluator, [&val2](int value) { val2 += value; });
+
+        signal1.emit(1);
+        signal2.emit(2);
+        signal1.emit(3);
+        signal1.disconnectAll();
+
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(val1 == 0);
+        REQUIRE(val2 == 2);
+    }
 
+#ifndef KDBINDINGS_SINGLE_THREADED
     SUBCASE("Emit Multiple Signals with Evaluator")
     {
         Signal<int> signal1;
@@ -471,6 +946,7 @@ TEST_CASE("ConnectionEvaluator")
         REQUIRE(val1 == 6);
         REQUIRE(val2 == 7);
     }
+#endif
 
     SUBCASE("Deferred Connect, Emit, Disconnect, and Evaluate")
     {
@@ -493,6 +969,45 @@ TEST_CASE("ConnectionEvaluator")
         REQUIRE(val == 4);
     }
 
+    SUBCASE("Disconnecting during the evaluation skips the remaining invocations of the connection")
+    {
+        Signal<int> signal;
+        int val = 0;
+        auto evaluator = std::make_shared<ConnectionEvaluator>();
+
+        ConnectionHandle other;
+        (void)signal.connectDeferred(evaluator, [&](int value) {
+            val += value;
+            other.disconnect();
+        });
+        other = signal.connectDeferred(evaluator, [&val](int value) { val += 100 * value; });
+
+        // The first invocation of either connection may be evaluated first,
+        // but the second invocation of `other` always comes after the disconnect.
+        signal.emit(1);
+        signal.emit(2);
+        evaluator->evaluateDeferredConnections();
+        REQUIRE((val == 3 || val == 103));
+    }
+
+    SUBCASE("A disconnected connection doesn't affect the invocations of a reconnected one")
+    {
+        Signal<int> signal;
+        int val = 0;
+        auto evaluator = std::make_shared<ConnectionEvaluator>();
+
+        auto connection = signal.connectDeferred(evaluator, [&val](int value) { val += value; });
+        signal.emit(1);
+        connection.disconnect();
+
+        // The new connection may reuse the index of the disconnected one.
+        (void)signal.connectDeferred(evaluator, [&val](int value) { val += 10 * value; });
+        signal.emit(2);
+
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(val == 20);
+    }
+
     SUBCASE("Double Evaluate Deferred Connections")
     {
         Signal<int> signal;
@@ -576,6 +1091,337 @@ TEST_CASE("ConnectionEvaluator")
         REQUIRE(evaluator->m_count == 1);
         REQUIRE(evaluated);
     }
+
+    SUBCASE("Evaluating a limited number of invocations keeps the rest queued in order")
+    {
+        auto evaluator = std::make_shared<ConnectionEvaluator>();
+        Signal<int> signal;
+        std::vector<int> values;
+        auto handle = signal.connectDeferred(evaluator, [&values](int value) { values.push_back(value); });
+        int otherCalls = 0;
+        auto otherHandle = signal.connectDeferred(evaluator, [&otherCalls](int) { ++otherCalls; });
+
+        for (int i = 1; i <= 5; ++i) {
+            signal.emit(i);
+        }
+        REQUIRE(evaluator->evaluateDeferredConnections(3) == 7);
+        REQUIRE(values == std::vector<int>{ 1, 2 });
+        REQUIRE(otherCalls == 1);
+
+        // Invocations of disconnected connections are neither evaluated nor counted.
+        otherHandle.disconnect();
+        signal.emit(6);
+        REQUIRE(evaluator->evaluateDeferredConnections(2) == 2);
+        REQUIRE(values == std::vector<int>{ 1, 2, 3, 4 });
+
+        REQUIRE(evaluator->evaluateDeferredConnections(0) == 2);
+        REQUIRE(values.size() == 4);
+
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(values == std::vector<int>{ 1, 2, 3, 4, 5, 6 });
+        REQUIRE(evaluator->evaluateDeferredConnections(10) == 0);
+
+        handle.disconnect();
+    }
+
+    SUBCASE("Evaluating for a limited time keeps the rest queued in order")
+    {
+        auto evaluator = std::make_shared<ConnectionEvaluator>();
+        Signal<int> signal;
+        std::vector<int> values;
+        (void)signal.connectDeferred(evaluator, [&values](int value) {
+            values.push_back(value);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        });
+
+        signal.emit(1);
+        signal.emit(2);
+        signal.emit(3);
+        REQUIRE(evaluator->evaluateFor(std::chrono::milliseconds(0)) == 3);
+        REQUIRE(values.empty());
+
+        // The first slot exceeds the time budget, so the evaluation stops after it.
+        REQUIRE(evaluator->evaluateFor(std::chrono::milliseconds(10)) == 2);
+        REQUIRE(values == std::vector<int>{ 1 });
+
+        REQUIRE(evaluator->evaluateFor(std::chrono::seconds(10)) == 0);
+        REQUIRE(values == std::vector<int>{ 1, 2, 3 });
+    }
+
+    SUBCASE("Invocations left by a timed evaluation don't delay higher priority invocations")
+    {
+        auto evaluator = std::make_shared<ConnectionEvaluator>();
+        Signal<int> lowSignal;
+        Signal<int> highSignal;
+        std::vector<std::string> calls;
+        (void)lowSignal.connectDeferred(evaluator, [&calls](int value) {
+            calls.push_back("low " + std::to_string(value));
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        },
+                                        DeferredConnectionPriority::Low);
+        (void)highSignal.connectDeferred(evaluator, [&calls](int value) { calls.push_back("high " + std::to_string(value)); }, DeferredConnectionPriority::High);
+
+        lowSignal.emit(1);
+        lowSignal.emit(2);
+        lowSignal.emit(3);
+        REQUIRE(evaluator->evaluateFor(std::chrono::milliseconds(10)) == 2);
+
+        highSignal.emit(1);
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(calls == std::vector<std::string>{ "low 1", "high 1", "low 2", "low 3" });
+    }
+
+    SUBCASE("Invocations of disconnected connections don't keep other lanes from being evaluated")
+    {
+        auto evaluator = std::make_shared<ConnectionEvaluator>();
+        Signal<int> highSignal;
+        Signal<int> normalSignal;
+        std::vector<int> highValues;
+        std::vector<int> normalValues;
+        int disconnectedCalls = 0;
+        (void)highSignal.connectDeferred(evaluator, [&highValues](int value) { highValues.push_back(value); }, DeferredConnectionPriority::High);
+        auto disconnectedHandle = highSignal.connectDeferred(evaluator, [&disconnectedCalls](int) { ++disconnectedCalls; }, DeferredConnectionPriority::High);
+        (void)normalSignal.connectDeferred(evaluator, [&normalValues](int value) { normalValues.push_back(value); });
+
+        highSignal.emit(1);
+        highSignal.emit(2);
+        for (int i = 1; i <= 6; ++i) {
+            normalSignal.emit(i);
+        }
+        disconnectedHandle.disconnect();
+
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(highValues == std::vector<int>{ 1, 2 });
+        REQUIRE(normalValues == std::vector<int>{ 1, 2, 3, 4, 5, 6 });
+
+        // Enough invocations that a timed evaluation takes them in multiple chunks.
+        highValues.clear();
+        normalValues.clear();
+        disconnectedHandle = highSignal.connectDeferred(evaluator, [&disconnectedCalls](int) { ++disconnectedCalls; }, DeferredConnectionPriority::High);
+        for (int i = 1; i <= 3; ++i) {
+            highSignal.emit(i);
+        }
+        for (int i = 1; i <= 100; ++i) {
+            normalSignal.emit(i);
+        }
+        disconnectedHandle.disconnect();
+
+        REQUIRE(evaluator->evaluateFor(std::chrono::seconds(10)) == 0);
+        REQUIRE(highValues == std::vector<int>{ 1, 2, 3 });
+        REQUIRE(normalValues.size() == 100);
+        REQUIRE(normalValues.back() == 100);
+        REQUIRE(disconnectedCalls == 0);
+    }
+
+    SUBCASE("A conflated invocation left by a timed evaluation is still replaced by later emits")
+    {
+        auto evaluator = std::make_shared<ConnectionEvaluator>();
+        Signal<int> signal;
+        (void)signal.connectDeferred(evaluator, [](int value) {
+            if (value == 1) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+        });
+        std::vector<int> conflatedValues;
+        (void)signal.connectDeferred(evaluator, [&conflatedValues](int value) { conflatedValues.push_back(value); }, DeferredConnectionMode::Conflated);
+
+        signal.emit(1);
+        REQUIRE(evaluator->evaluateFor(std::chrono::milliseconds(10)) == 1);
+        REQUIRE(conflatedValues.empty());
+
+        signal.emit(2);
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(conflatedValues == std::vector<int>{ 2 });
+    }
+
+#ifndef KDBINDINGS_SINGLE_THREADED
+    SUBCASE("Emitting doesn't wait for slots that are being evaluated")
+    {
+        auto evaluator = std::make_shared<ConnectionEvaluator>();
+        Signal<int> signal;
+        std::atomic<bool> slotRunning{ false };
+        std::atomic<bool> emitted{ false };
+        (void)signal.connectDeferred(evaluator, [&](int value) {
+            if (value == 1) {
+                slotRunning = true;
+                while (!emitted.load()) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        signal.emit(1);
+        std::thread evaluatingThread([&evaluator]() { evaluator->evaluateDeferredConnections(); });
+        while (!slotRunning.load()) {
+            std::this_thread::yield();
+        }
+        // Would never return if emitting had to wait for the running slot.
+        signal.emit(2);
+        emitted = true;
+        evaluatingThread.join();
+    }
+#endif
+
+    SUBCASE("Invocations queued by a slot are evaluated by the next evaluation")
+    {
+        auto evaluator = std::make_shared<ConnectionEvaluator>();
+        Signal<int> signal;
+        std::vector<int> values;
+        (void)signal.connectDeferred(evaluator, [&](int value) {
+            values.push_back(value);
+            if (value == 0) {
+                // Enough invocations to grow the queue while the slot is running.
+                for (int i = 1; i <= 100; ++i) {
+                    signal.emit(i);
+                }
+            }
+        });
+
+        signal.emit(0);
+        REQUIRE(evaluator->evaluateDeferredConnections(10) == 100);
+        REQUIRE(values == std::vector<int>{ 0 });
+
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(values.size() == 101);
+        REQUIRE(values.back() == 100);
+    }
+
+    SUBCASE("Invocations of higher priority connections are evaluated first")
+    {
+        auto evaluator = std::make_shared<ConnectionEvaluator>();
+        Signal<int> signal;
+        std::vector<std::string> calls;
+        (void)signal.connectDeferred(evaluator, [&calls](int value) { calls.push_back("low " + std::to_string(value)); }, DeferredConnectionPriority::Low);
+        (void)signal.connectDeferred(evaluator, [&calls](int value) { calls.push_back("normal " + std::to_string(value)); });
+        (void)signal.connectDeferred(evaluator, [&calls](int value) { calls.push_back("high " + std::to_string(value)); }, DeferredConnectionMode::Queued, DeferredConnectionPriority::High);
+
+        signal.emit(1);
+        signal.emit(2);
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(calls == std::vector<std::string>{ "high 1", "high 2", "normal 1", "normal 2", "low 1", "low 2" });
+
+        // A limited evaluation takes the highest priority invocations.
+        calls.clear();
+        signal.emit(3);
+        REQUIRE(evaluator->evaluateDeferredConnections(2) == 1);
+        REQUIRE(calls == std::vector<std::string>{ "high 3", "normal 3" });
+    }
+
+    SUBCASE("Lower priority invocations are not starved by higher priority invocations")
+    {
+        auto evaluator = std::make_shared<ConnectionEvaluator>();
+        Signal<> highSignal;
+        Signal<> lowSignal;
+        std::size_t highCalls = 0;
+        std::size_t highCallsBeforeLowCall = 0;
+        (void)highSignal.connectDeferred(evaluator, [&highCalls]() { ++highCalls; }, DeferredConnectionPriority::High);
+        (void)lowSignal.connectDeferred(evaluator, [&]() { highCallsBeforeLowCall = highCalls; }, DeferredConnectionPriority::Low);
+
+        lowSignal.emit();
+        for (std::size_t i = 0; i < 2 * ConnectionEvaluator::StarvationLimit; ++i) {
+            highSignal.emit();
+        }
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(highCalls == 2 * ConnectionEvaluator::StarvationLimit);
+        REQUIRE(highCallsBeforeLowCall == ConnectionEvaluator::StarvationLimit);
+    }
+
+    SUBCASE("Invocations of disconnected connections don't count towards the starvation limit")
+    {
+        auto evaluator = std::make_shared<ConnectionEvaluator>();
+        Signal<> highSignal;
+        Signal<> lowSignal;
+        std::size_t highCalls = 0;
+        std::vector<std::size_t> highCallsBeforeLowCalls;
+        (void)highSignal.connectDeferred(evaluator, [&highCalls]() { ++highCalls; }, DeferredConnectionPriority::High);
+        auto disconnectedHandle = highSignal.connectDeferred(evaluator, [&highCalls]() { ++highCalls; }, DeferredConnectionPriority::High);
+        (void)lowSignal.connectDeferred(evaluator, [&]() { highCallsBeforeLowCalls.push_back(highCalls); }, DeferredConnectionPriority::Low);
+
+        for (int i = 0; i < 11; ++i) {
+            lowSignal.emit();
+        }
+        for (int i = 0; i < 10; ++i) {
+            highSignal.emit();
+        }
+        disconnectedHandle.disconnect();
+
+        // Only the 10 invocations of the connected high priority slot are taken, which leaves room for 10 low priority ones.
+        REQUIRE(evaluator->evaluateDeferredConnections(20) == 1);
+        REQUIRE(highCalls == 10);
+        REQUIRE(highCallsBeforeLowCalls == std::vector<std::size_t>(10, 10));
+
+        // The remaining low priority invocation waited for 10 high priority invocations already.
+        for (std::size_t i = 0; i < 2 * ConnectionEvaluator::StarvationLimit; ++i) {
+            highSignal.emit();
+        }
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(highCalls == 10 + 2 * ConnectionEvaluator::StarvationLimit);
+        REQUIRE(highCallsBeforeLowCalls.size() == 11);
+        REQUIRE(highCallsBeforeLowCalls.back() == ConnectionEvaluator::StarvationLimit);
+    }
+
+    SUBCASE("A conflated connection only evaluates the latest emit")
+    {
+        class MyConnectionEvaluator : public ConnectionEvaluator
+        {
+        protected:
+            void onInvocationAdded() override
+            {
+                m_count++;
+            }
+
+        public:
+            int m_count = 0;
+        };
+
+        auto evaluator = std::make_shared<MyConnectionEvaluator>();
+        Signal<int> signal;
+        std::vector<int> conflatedValues;
+        std::vector<int> queuedValues;
+        (void)signal.connectDeferred(evaluator, [&conflatedValues](int value) { conflatedValues.push_back(value); }, DeferredConnectionMode::Conflated);
+        (void)signal.connectDeferred(evaluator, [&queuedValues](int value) { queuedValues.push_back(value); });
+
+        for (int i = 1; i <= 100; ++i) {
+            signal.emit(i);
+        }
+        // Only the first emit of the conflated connection queued an invocation.
+        REQUIRE(evaluator->m_count == 101);
+
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(conflatedValues == std::vector<int>{ 100 });
+        REQUIRE(queuedValues.size() == 100);
+
+        // Once evaluated, the next emit queues a new invocation.
+        signal.emit(200);
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(conflatedValues == std::vector<int>{ 100, 200 });
+
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(conflatedValues.size() == 2);
+    }
+
+    SUBCASE("A disconnected conflated connection is not evaluated")
+    {
+        auto evaluator = std::make_shared<ConnectionEvaluator>();
+        Signal<int> signal;
+        int calls = 0;
+        auto handle = signal.connectDeferred(evaluator, [&calls](int) { ++calls; }, DeferredConnectionMode::Conflated);
+
+        signal.emit(1);
+        signal.emit(2);
+        handle.disconnect();
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(calls == 0);
+
+        // A new connection may reuse the index of the disconnected one.
+        int value = 0;
+        (void)signal.connectDeferred(evaluator, [&value](int newValue) { value = newValue; }, DeferredConnectionMode::Conflated);
+        signal.emit(3);
+        signal.emit(4);
+        evaluator->evaluateDeferredConnections();
+        REQUIRE(calls == 0);
+        REQUIRE(value == 4);
+    }
 }
 
 TEST_CASE("Moving")
@@ -0,0 +1,93 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include <kdbindings/static_signal.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <doctest.h>
+
+// The expansion of TEST_CASE from doctest leads to a clazy warning.
+// As this issue originates from doctest, disable the warning.
+// clazy:excludeall=non-pod-global-static
+
+using namespace KDBindings;
+
+namespace {
+
+struct Receiver {
+    void onValue(int value) { values.push_back(value); }
+    std::vector<int> values;
+};
+
+void freeSlot(int)
+{
+}
+
+} // namespace
+
+// A StaticSignal only contains its slots.
+static_assert(sizeof(StaticSignal<void(int), void (*)(int)>) == sizeof(void (*)(int)));
+
+TEST_CASE("StaticSignal")
+{
+    SUBCASE("Calls all slots in order")
+    {
+        std::vector<std::string> calls;
+        auto signal = makeStaticSignal<void(int, const std::string &)>(
+                [&calls](int value, const std::string &name) { calls.push_back(name + std::to_string(value)); },
+                [&calls](int value, const std::string &) { calls.push_back(std::to_string(value * 2)); });
+
+        signal.emit(1, "a");
+        signal.emit(2, "b");
+        REQUIRE(calls == std::vector<std::string>{ "a1", "2", "b2", "4" });
+    }
+
+    SUBCASE("Can call free functions and member function pointers")
+    {
+        Receiver receiver;
+        auto signal = makeStaticSignal<void(Receiver &, int)>(&Receiver::onValue);
+        signal.emit(receiver, 5);
+        REQUIRE(receiver.values == std::vector<int>{ 5 });
+
+        auto freeSignal = makeStaticSignal<void(int)>(&freeSlot);
+        freeSignal.emit(1);
+    }
+
+    SUBCASE("Mutable slots keep their state")
+    {
+        int last = 0;
+        auto signal = makeStaticSignal<void()>([count = 0, &last]() mutable { last = ++count; });
+        signal.emit();
+        signal.emit();
+        REQUIRE(last == 2);
+    }
+
+    SUBCASE("Does not copy the emitted values")
+    {
+        auto pointer = std::make_unique<int>(3);
+        int sum = 0;
+        auto signal = makeStaticSignal<void(std::unique_ptr<int>)>(
+                [&sum](const std::unique_ptr<int> &value) { sum += *value; },
+                [&sum](const std::unique_ptr<int> &value) { sum += *value; });
+        signal.emit(pointer);
+        REQUIRE(sum == 6);
+    }
+
+    SUBCASE("Can modify values emitted by non-const reference")
+    {
+        auto signal = makeStaticSignal<void(int &)>([](int &value) { ++value; }, [](int &value) { value *= 2; });
+        int value = 1;
+        signal.emit(value);
+        REQUIRE(value == 4);
+    }
+}
@@ -0,0 +1,293 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include <kdbindings/thread_safe_signal.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <doctest.h>
+
+// The expansion of TEST_CASE from doctest leads to a clazy warning.
+// As this issue originates from doctest, disable the warning.
+// clazy:excludeall=non-pod-global-static
+
+using namespace KDBindings;
+
+static_assert(std::is_nothrow_destructible<ThreadSafeSignal<int>>{});
+static_assert(std::is_default_constructible<ThreadSafeSignal<int>>{});
+static_assert(!std::is_copy_constructible<ThreadSafeSignal<int>>{});
+static_assert(!std::is_copy_assignable<ThreadSafeSignal<int>>{});
+static_assert(std::is_nothrow_move_constructible<ThreadSafeSignal<int>>{});
+static_assert(std::is_nothrow_move_assignable<ThreadSafeSignal<int>>{});
+
+TEST_CASE("ThreadSafeSignal")
+{
+    SUBCASE("Can connect and emit")
+    {
+        ThreadSafeSignal<int, bool> signal;
+        int sum = 0;
+        auto handle = signal.connect([&sum](int value, bool add) {
+            if (add) {
+                sum += value;
+            }
+        });
+        REQUIRE(handle.isActive());
+        REQUIRE(handle.belongsTo(signal));
+
+        signal.emit(3, true);
+        signal.emit(5, false);
+        REQUIRE(sum == 3);
+    }
+
+    SUBCASE("Can connect member functions and discard arguments")
+    {
+        struct Counter {
+            void increment() { ++count; }
+            int count = 0;
+        };
+
+        ThreadSafeSignal<int> signal;
+        Counter counter;
+        (void)signal.connect(&Counter::increment, &counter);
+        signal.emit(1);
+        signal.emit(2);
+        REQUIRE(counter.count == 2);
+    }
+
+    SUBCASE("Disconnecting stops calling the slot")
+    {
+        ThreadSafeSignal<> signal;
+        int calls = 0;
+        auto handle = signal.connect([&calls]() { ++calls; });
+        signal.emit();
+        signal.disconnect(handle);
+        REQUIRE_FALSE(handle.isActive());
+        signal.emit();
+        REQUIRE(calls == 1);
+    }
+
+    SUBCASE("Using a handle of a different signal throws")
+    {
+        ThreadSafeSignal<> signal;
+        ThreadSafeSignal<> otherSignal;
+        auto handle = otherSignal.connect([]() {});
+        REQUIRE_FALSE(handle.belongsTo(signal));
+        REQUIRE_THROWS_AS(signal.disconnect(handle), std::out_of_range);
+        REQUIRE_THROWS_AS(signal.blockConnection(handle, true), std::out_of_range);
+        REQUIRE(handle.isActive());
+    }
+
+    SUBCASE("Disconnecting releases the slot")
+    {
+        ThreadSafeSignal<> signal;
+        auto shared = std::make_shared<int>(0);
+        auto handle = signal.connect([shared]() { ++*shared; });
+        REQUIRE(shared.use_count() == 2);
+
+        signal.emit();
+        handle.disconnect();
+        REQUIRE(shared.use_count() == 1);
+        REQUIRE(*shared == 1);
+    }
+
+    SUBCASE("Can block connections")
+    {
+        ThreadSafeSignal<> signal;
+        int calls = 0;
+        auto handle = signal.connect([&calls]() { ++calls; });
+
+        REQUIRE_FALSE(handle.block(true));
+        REQUIRE(signal.isConnectionBlocked(handle));
+        signal.emit();
+        REQUIRE(calls == 0);
+
+        {
+            ConnectionBlocker blocker(handle);
+        }
+        REQUIRE(signal.isConnectionBlocked(handle));
+
+        REQUIRE(signal.blockConnection(handle, false));
+        signal.emit();
+        REQUIRE(calls == 1);
+    }
+
+    SUBCASE("ScopedConnection disconnects the slot")
+    {
+        ThreadSafeSignal<> signal;
+        int calls = 0;
+        {
+            ScopedConnection connection = signal.connect([&calls]() { ++calls; });
+            signal.emit();
+        }
+        signal.emit();
+        REQUIRE(calls == 1);
+    }
+
+    SUBCASE("Handles are deactivated when the signal is destroyed")
+    {
+        ConnectionHandle handle;
+        {
+            ThreadSafeSignal<> signal;
+            handle = signal.connect([]() {});
+            REQUIRE(handle.isActive());
+        }
+        REQUIRE_FALSE(handle.isActive());
+    }
+
+    SUBCASE("Slots can disconnect themselves and connect new slots while being emitted")
+    {
+        ThreadSafeSignal<> signal;
+        int selfCalls = 0;
+        int newCalls = 0;
+
+        ConnectionHandle selfHandle;
+        selfHandle = signal.connect([&]() {
+            ++selfCalls;
+            selfHandle.disconnect();
+            (void)signal.connect([&newCalls]() { ++newCalls; });
+        });
+
+        signal.emit();
+        REQUIRE(selfCalls == 1);
+        REQUIRE(newCalls == 0);
+
+        signal.emit();
+        REQUIRE(selfCalls == 1);
+        REQUIRE(newCalls == 1);
+    }
+
+    SUBCASE("Slots can emit the signal again")
+    {
+        ThreadSafeSignal<int> signal;
+        int calls = 0;
+        (void)signal.connect([&](int depth) {
+            ++calls;
+            if (depth > 0) {
+                signal.emit(depth - 1);
+            }
+        });
+        signal.emit(3);
+        REQUIRE(calls == 4);
+    }
+
+    SUBCASE("Can emit on multiple threads at the same time")
+    {
+        ThreadSafeSignal<int> signal;
+        std::atomic<int> sum{ 0 };
+        (void)signal.connect([&sum](int value) { sum += value; });
+        (void)signal.connect([&sum](int value) { sum += value; });
+
+        constexpr int threadCount = 4;
+        constexpr int emitCount = 1000;
+        std::vector<std::thread> threads;
+        for (int i = 0; i < threadCount; ++i) {
+            threads.emplace_back([&signal]() {
+                for (int j = 0; j < emitCount; ++j) {
+                    signal.emit(1);
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        REQUIRE(sum == 2 * threadCount * emitCount);
+    }
+
+    SUBCASE("Can connect and disconnect while other threads emit")
+    {
+        ThreadSafeSignal<> signal;
+        std::atomic<int> permanentCalls{ 0 };
+        (void)signal.connect([&permanentCalls]() { ++permanentCalls; });
+
+        std::atomic<bool> stop{ false };
+        std::atomic<int> emitCount{ 0 };
+        std::vector<std::thread> emitters;
+        for (int i = 0; i < 2; ++i) {
+            emitters.emplace_back([&]() {
+                while (!stop) {
+                    signal.emit();
+                    ++emitCount;
+                }
+            });
+        }
+
+        auto counter = std::make_shared<std::atomic<int>>(0);
+        for (int i = 0; i < 200; ++i) {
+            auto handle = signal.connect([counter]() { ++*counter; });
+            std::this_thread::yield();
+            signal.disconnect(handle);
+        }
+
+        stop = true;
+        for (auto &thread : emitters) {
+            thread.join();
+        }
+
+        REQUIRE(permanentCalls == emitCount);
+        // All temporary slots have been released once nobody is emitting anymore.
+        signal.disconnectAll();
+        REQUIRE(counter.use_count() == 1);
+    }
+
+    SUBCASE("Replaced snapshots are released while other threads keep emitting")
+    {
+        ThreadSafeSignal<> signal;
+        std::atomic<bool> stop{ false };
+        // Every emit waits in its slot until the next emit has started, so at any time
+        // at least one thread is emitting the signal.
+        std::atomic<int> entered{ 0 };
+        (void)signal.connect([&]() {
+            const auto ticket = entered.fetch_add(1);
+            while (entered.load() == ticket + 1 && !stop) {
+                std::this_thread::yield();
+            }
+        });
+
+        std::vector<std::thread> emitters;
+        for (int i = 0; i < 2; ++i) {
+            emitters.emplace_back([&]() {
+                while (!stop) {
+                    signal.emit();
+                }
+            });
+        }
+
+        while (entered.load() < 2) {
+            std::this_thread::yield();
+        }
+
+        // Every snapshot that contains the temporary slot keeps a copy of the counter alive.
+        auto counter = std::make_shared<int>(0);
+        bool bounded = true;
+        for (int i = 0; i < 200 && bounded; ++i) {
+            auto handle = signal.connect([counter]() { ++*counter; });
+            signal.disconnect(handle);
+
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (counter.use_count() > 1 && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+            bounded = counter.use_count() == 1;
+        }
+
+        stop = true;
+        for (auto &thread : emitters) {
+            thread.join();
+        }
+
+        REQUIRE(bounded);
+    }
+}
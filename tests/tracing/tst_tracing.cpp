@@ -0,0 +1,198 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include <kdbindings/binding.h>
+#include <kdbindings/connection_evaluator.h>
+#include <kdbindings/property.h>
+#include <kdbindings/signal.h>
+#include <kdbindings/tracing.h>
+#include <kdbindings/tracing_json.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+// The expansion of TEST_CASE from doctest leads to a clazy warning.
+// As this issue originates from doctest, disable the warning.
+// clazy:excludeall=non-pod-global-static
+
+using namespace KDBindings;
+
+static_assert(Tracer::isEnabled());
+
+namespace {
+
+struct Span {
+    std::string name;
+    uint64_t tid = 0;
+    uint64_t parent = 0;
+};
+
+std::string field(const std::string &line, const std::string &name)
+{
+    const auto key = "\"" + name + "\": ";
+    const auto start = line.find(key);
+    if (start == std::string::npos) {
+        return {};
+    }
+    auto begin = start + key.size();
+    if (line[begin] == '"') {
+        ++begin;
+        return line.substr(begin, line.find('"', begin) - begin);
+    }
+    return line.substr(begin, line.find_first_of(",} ", begin) - begin);
+}
+
+// The Tracer writes one event per line, which makes it easy to read back the spans.
+std::map<uint64_t, Span> recordedSpans()
+{
+    std::ostringstream stream;
+    writeChromeTrace(stream);
+
+    std::map<uint64_t, Span> spans;
+    std::istringstream lines(stream.str());
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (field(line, "ph") == "X") {
+            spans[std::stoull(field(line, "id"))] = Span{ field(line, "name"), std::stoull(field(line, "tid")), std::stoull(field(line, "parent")) };
+        }
+    }
+    return spans;
+}
+
+// Returns the names of the span and all of its ancestors, starting with the root.
+std::vector<std::string> causes(const std::map<uint64_t, Span> &spans, uint64_t id)
+{
+    std::vector<std::string> names;
+    for (auto it = spans.find(id); it != spans.end(); it = spans.find(it->second.parent)) {
+        names.insert(names.begin(), it->second.name);
+    }
+    return names;
+}
+
+uint64_t findSpan(const std::map<uint64_t, Span> &spans, const std::string &name)
+{
+    uint64_t result = 0;
+    for (const auto &[id, span] : spans) {
+        if (span.name == name) {
+            result = id; // The last span with the name is the most deeply nested one.
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+TEST_CASE("Tracer")
+{
+    SUBCASE("Records nothing while it is not recording")
+    {
+        Tracer::instance().start();
+        Tracer::instance().stop();
+
+        Signal<int> signal;
+        (void)signal.connect([](int) { });
+        signal.emit(1);
+
+        REQUIRE(Tracer::instance().eventCount() == 0);
+    }
+
+    SUBCASE("Records the cascade of a Property::set")
+    {
+        Property<int> source(1);
+        auto bound = makeBoundProperty(source * 2);
+        int received = 0;
+        (void)bound.valueChanged().connect([&received](int value) { received = value; });
+
+        Tracer::instance().start();
+        source = 2;
+        Tracer::instance().stop();
+        REQUIRE(received == 4);
+
+        const auto spans = recordedSpans();
+        const auto evaluate = findSpan(spans, "Binding::evaluate");
+        REQUIRE(evaluate != 0);
+        REQUIRE(causes(spans, evaluate) == std::vector<std::string>{ "Property::set", "Signal::emit", "slot", "Binding::evaluate" });
+
+        // The evaluation sets the bound Property, which emits its valueChanged Signal.
+        std::vector<std::string> innermost;
+        for (const auto &[id, span] : spans) {
+            if (causes(spans, id).size() > innermost.size()) {
+                innermost = causes(spans, id);
+            }
+        }
+        REQUIRE(innermost == std::vector<std::string>{ "Property::set", "Signal::emit", "slot", "Binding::evaluate", "Property::set", "Signal::emit", "slot" });
+    }
+
+    SUBCASE("Deferred slots are caused by the emit that queued them")
+    {
+        auto evaluator = std::make_shared<ConnectionEvaluator>();
+        Signal<int> signal;
+        int received = 0;
+        (void)signal.connectDeferred(evaluator, [&received](int value) { received = value; });
+
+        Tracer::instance().start();
+        signal.emit(5);
+        std::thread([&evaluator] { evaluator->evaluateDeferredConnections(); }).join();
+        Tracer::instance().stop();
+        REQUIRE(received == 5);
+
+        const auto spans = recordedSpans();
+        const auto deferred = findSpan(spans, "deferred slot");
+        REQUIRE(deferred != 0);
+        REQUIRE(causes(spans, deferred) == std::vector<std::string>{ "Signal::emit", "slot", "deferred slot" });
+
+        const auto evaluation = findSpan(spans, "ConnectionEvaluator::evaluateDeferredConnections");
+        REQUIRE(evaluation != 0);
+        REQUIRE(spans.at(evaluation).tid == spans.at(deferred).tid);
+        REQUIRE(spans.at(evaluation).tid != spans.at(findSpan(spans, "Signal::emit")).tid);
+    }
+
+    SUBCASE("Writes the Chrome Trace Event format")
+    {
+        Signal<> signal;
+        (void)signal.connect([] { });
+
+        Tracer::instance().start();
+        signal.emit();
+        Tracer::instance().stop();
+
+        std::ostringstream stream;
+        writeChromeTrace(stream);
+        const auto json = stream.str();
+
+        REQUIRE(json.find("\"traceEvents\": [") != std::string::npos);
+        REQUIRE(json.find("{ \"name\": \"Signal::emit\", \"cat\": \"signal\", \"ph\": \"X\", \"ts\": ") != std::string::npos);
+        REQUIRE(json.find("\"pid\": 1") != std::string::npos);
+        REQUIRE(Tracer::instance().eventCount() == 2);
+    }
+
+    SUBCASE("Drops events beyond the limit")
+    {
+        Signal<> signal;
+        (void)signal.connect([] { });
+
+        Tracer::instance().start(3);
+        for (int i = 0; i < 5; ++i) {
+            signal.emit();
+        }
+        Tracer::instance().stop();
+
+        REQUIRE(Tracer::instance().eventCount() == 3);
+        REQUIRE(Tracer::instance().droppedEvents() == 7);
+    }
+}
@@ -12,6 +12,7 @@
 #include <kdbindings/genindex_array.h>
 #include <type_traits>
 #include <set>
+#include <vector>
 
 #include <doctest.h>
 
@@ -94,6 +95,34 @@ TEST_CASE("Insertion")
         REQUIRE(*array.get(index) == 5);
         REQUIRE(*array.get(index2) == 7);
     }
+
+    SUBCASE("indices can be allocated before a value is set")
+    {
+        GenerationalIndexArray<int> array;
+
+        auto index = array.insert(5);
+        auto allocated = array.allocateIndex();
+        REQUIRE(array.entriesSize() == 1);
+        REQUIRE(array.get(allocated) == nullptr);
+        REQUIRE_FALSE(array.indexAtEntry(allocated.index));
+
+        array.set(allocated, 7);
+        REQUIRE(*array.get(index) == 5);
+        REQUIRE(*array.get(allocated) == 7);
+    }
+
+    SUBCASE("allocated indices can be erased before a value is set")
+    {
+        GenerationalIndexArray<int> array;
+
+        auto allocated = array.allocateIndex();
+        array.erase(allocated);
+        REQUIRE(array.get(allocated) == nullptr);
+
+        auto index = array.insert(5);
+        REQUIRE(*array.get(index) == 5);
+        REQUIRE_FALSE(index == allocated);
+    }
 }
 
 TEST_CASE("Deletion")
@@ -201,3 +230,118 @@ TEST_CASE("indexAtEntry")
         }
     }
 }
+
+TEST_CASE("DenseGenerationalIndexArray")
+{
+    SUBCASE("values can be inserted and retrieved")
+    {
+        DenseGenerationalIndexArray<int> array;
+        REQUIRE(array.size() == 0);
+
+        auto index = array.insert(5);
+        auto index2 = array.insert(7);
+
+        REQUIRE(array.size() == 2);
+        REQUIRE(*array.get(index) == 5);
+        REQUIRE(*array.get(index2) == 7);
+    }
+
+    SUBCASE("Erasing keeps the values packed and in order")
+    {
+        DenseGenerationalIndexArray<int> array;
+        std::vector<GenerationalIndex> indices;
+        for (int i = 0; i < 10; ++i) {
+            indices.push_back(array.insert(std::move(i)));
+        }
+
+        for (int i = 0; i < 10; i += 2) {
+            array.erase(indices[i]);
+        }
+
+        REQUIRE(array.size() == 5);
+        std::vector<int> values;
+        for (uint32_t position = 0; position < array.size(); ++position) {
+            values.push_back(array.valueAt(position));
+            REQUIRE(array.get(array.indexAt(position)) == &array.valueAt(position));
+        }
+        REQUIRE(values == std::vector<int>{ 1, 3, 5, 7, 9 });
+
+        for (int i = 0; i < 10; ++i) {
+            if (i % 2 == 0) {
+                REQUIRE(array.get(indices[i]) == nullptr);
+            } else {
+                REQUIRE(*array.get(indices[i]) == i);
+            }
+        }
+    }
+
+    SUBCASE("Erased indices are reused with a new generation")
+    {
+        DenseGenerationalIndexArray<int> array;
+
+        auto index = array.insert(5);
+        array.erase(index);
+        auto newIndex = array.insert(6);
+
+        REQUIRE(newIndex.index == index.index);
+        REQUIRE(newIndex.generation != index.generation);
+        REQUIRE(array.get(index) == nullptr);
+        REQUIRE(*array.get(newIndex) == 6);
+
+        // Erasing a stale index doesn't erase the new value
+        array.erase(index);
+        REQUIRE(*array.get(newIndex) == 6);
+    }
+
+    SUBCASE("indices can be allocated before a value is set")
+    {
+        DenseGenerationalIndexArray<int> array;
+
+        auto index = array.insert(5);
+        auto allocated = array.allocateIndex();
+        REQUIRE(array.size() == 1);
+        REQUIRE(array.get(allocated) == nullptr);
+
+        array.set(allocated, 7);
+        REQUIRE(array.size() == 2);
+        REQUIRE(*array.get(index) == 5);
+        REQUIRE(*array.get(allocated) == 7);
+
+        auto erasedBeforeSet = array.allocateIndex();
+        array.erase(erasedBeforeSet);
+        REQUIRE(array.size() == 2);
+    }
+
+    SUBCASE("Clear invalidates all indices")
+    {
+        DenseGenerationalIndexArray<int> array;
+
+        auto index = array.insert(5);
+        auto index2 = array.insert(7);
+
+        array.clear();
+        REQUIRE(array.size() == 0);
+        REQUIRE(array.get(index) == nullptr);
+        REQUIRE(array.get(index2) == nullptr);
+    }
+    SUBCASE("Clear keeps indices that don't have a value yet")
+    {
+        DenseGenerationalIndexArray<int> array;
+
+        auto index = array.insert(5);
+        auto allocated = array.allocateIndex();
+
+        array.clear();
+        REQUIRE(array.get(index) == nullptr);
+
+        array.set(allocated, 7);
+        REQUIRE(array.size() == 1);
+        REQUIRE(*array.get(allocated) == 7);
+
+        // The index of the cleared value is reused with a new generation.
+        auto reused = array.insert(9);
+        REQUIRE(reused.index == index.index);
+        REQUIRE(reused.generation != index.generation);
+        REQUIRE(array.get(index) == nullptr);
+    }
+}
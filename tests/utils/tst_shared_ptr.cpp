@@ -0,0 +1,119 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include <kdbindings/shared_ptr.h>
+
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include <doctest.h>
+
+// The expansion of TEST_CASE from doctest leads to a clazy warning.
+// As this issue originates from doctest, disable the warning.
+// clazy:excludeall=non-pod-global-static
+
+using namespace KDBindings::Private;
+
+namespace {
+
+struct Base : public EnableLocalSharedFromThis<Base> {
+    virtual ~Base() = default;
+};
+
+struct Derived : public Base {
+    explicit Derived(int *destructions)
+        : m_destructions(destructions)
+    {
+    }
+    ~Derived() override { ++*m_destructions; }
+
+    int *m_destructions;
+};
+
+struct Throwing {
+    Throwing() { throw std::runtime_error("construction failed"); }
+};
+
+} // namespace
+
+static_assert(std::is_nothrow_copy_constructible<LocalSharedPtr<int>>{});
+static_assert(std::is_nothrow_move_constructible<LocalSharedPtr<int>>{});
+static_assert(std::is_nothrow_copy_constructible<LocalWeakPtr<int>>{});
+static_assert(std::is_nothrow_move_constructible<LocalWeakPtr<int>>{});
+static_assert(std::is_convertible<LocalSharedPtr<Derived>, LocalSharedPtr<Base>>{});
+static_assert(std::is_convertible<LocalSharedPtr<Derived>, LocalWeakPtr<Base>>{});
+static_assert(!std::is_convertible<LocalSharedPtr<Base>, LocalSharedPtr<Derived>>{});
+
+TEST_CASE("LocalSharedPtr")
+{
+    SUBCASE("Counts strong references")
+    {
+        auto pointer = makeLocalShared<int>(42);
+        REQUIRE(*pointer == 42);
+        REQUIRE(pointer.use_count() == 1);
+
+        auto copy = pointer;
+        REQUIRE(copy.get() == pointer.get());
+        REQUIRE(pointer.use_count() == 2);
+
+        auto moved = std::move(copy);
+        REQUIRE_FALSE(copy);
+        REQUIRE(pointer.use_count() == 2);
+
+        moved.reset();
+        REQUIRE(pointer.use_count() == 1);
+    }
+
+    SUBCASE("Destroys the object with the last strong reference")
+    {
+        int destructions = 0;
+        LocalWeakPtr<Base> weak;
+        {
+            LocalSharedPtr<Base> pointer = makeLocalShared<Derived>(&destructions);
+            weak = pointer;
+            REQUIRE_FALSE(weak.expired());
+            REQUIRE(weak.lock().get() == pointer.get());
+        }
+        REQUIRE(destructions == 1);
+        REQUIRE(weak.expired());
+        REQUIRE_FALSE(weak.lock());
+    }
+
+    SUBCASE("Supports weak_from_this and shared_from_this")
+    {
+        int destructions = 0;
+        auto pointer = makeLocalShared<Derived>(&destructions);
+
+        auto weak = pointer->weak_from_this();
+        REQUIRE(weak.lock().get() == pointer.get());
+
+        auto shared = pointer->shared_from_this();
+        REQUIRE(pointer.use_count() == 2);
+        shared.reset();
+
+        pointer.reset();
+        REQUIRE(destructions == 1);
+        REQUIRE(weak.expired());
+    }
+
+    SUBCASE("shared_from_this throws for objects that are not owned by a LocalSharedPtr")
+    {
+        int destructions = 0;
+        Derived object(&destructions);
+        REQUIRE_THROWS_AS(object.shared_from_this(), std::bad_weak_ptr);
+        REQUIRE(object.weak_from_this().expired());
+    }
+
+    SUBCASE("makeLocalShared does not leak if the constructor throws")
+    {
+        REQUIRE_THROWS_AS(makeLocalShared<Throwing>(), std::runtime_error);
+    }
+}
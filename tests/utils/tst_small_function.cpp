@@ -0,0 +1,156 @@
+/*
+  This file is part of KDBindings.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: MIT
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include <kdbindings/small_function.h>
+
+#include <array>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include <doctest.h>
+
+// The expansion of TEST_CASE from doctest leads to a clazy warning.
+// As this issue originates from doctest, disable the warning.
+// clazy:excludeall=non-pod-global-static
+
+using namespace KDBindings::Private;
+
+static_assert(std::is_nothrow_destructible<SmallFunction<void()>>{});
+static_assert(std::is_nothrow_default_constructible<SmallFunction<void()>>{});
+static_assert(!std::is_copy_constructible<SmallFunction<void()>>{});
+static_assert(!std::is_copy_assignable<SmallFunction<void()>>{});
+static_assert(std::is_nothrow_move_constructible<SmallFunction<void()>>{});
+static_assert(std::is_nothrow_move_assignable<SmallFunction<void()>>{});
+
+static_assert(SmallFunction<void()>::storesInline<std::function<void()>>());
+static_assert(SmallFunction<void()>::storesInline<void (*)()>());
+static_assert(!SmallFunction<void()>::storesInline<std::array<char, SmallFunctionDefaultCapacity + 1>>());
+
+namespace {
+
+struct Counter {
+    void increment(int amount) { value += amount; }
+    int value = 0;
+};
+
+int freeFunction(int value)
+{
+    return value * 2;
+}
+
+} // namespace
+
+TEST_CASE("SmallFunction")
+{
+    SUBCASE("A default constructed SmallFunction is empty")
+    {
+        SmallFunction<void()> function;
+        REQUIRE_FALSE(function);
+    }
+
+    SUBCASE("A SmallFunction constructed from an empty callable is empty")
+    {
+        SmallFunction<void()> fromFunctionPointer(static_cast<void (*)()>(nullptr));
+        REQUIRE_FALSE(fromFunctionPointer);
+
+        SmallFunction<void()> fromStdFunction(std::function<void()>{});
+        REQUIRE_FALSE(fromStdFunction);
+    }
+
+    SUBCASE("Can call a small lambda")
+    {
+        int called = 0;
+        SmallFunction<void(int)> function([&called](int value) { called += value; });
+        REQUIRE(function);
+
+        function(5);
+        function(2);
+        REQUIRE(called == 7);
+    }
+
+    SUBCASE("Can call a large lambda that does not fit inline")
+    {
+        std::array<int, 32> data{};
+        data[31] = 42;
+        int result = 0;
+        auto lambda = [data, &result]() { result = data[31]; };
+        static_assert(!SmallFunction<void()>::storesInline<decltype(lambda)>());
+
+        SmallFunction<void()> function(lambda);
+        function();
+        REQUIRE(result == 42);
+    }
+
+    SUBCASE("Can call free functions and return values")
+    {
+        SmallFunction<int(int)> function(&freeFunction);
+        REQUIRE(function(21) == 42);
+    }
+
+    SUBCASE("Can call a member function pointer")
+    {
+        Counter counter;
+        SmallFunction<void(Counter &, int)> function(&Counter::increment);
+        function(counter, 3);
+        REQUIRE(counter.value == 3);
+    }
+
+    SUBCASE("Mutable lambdas keep their state")
+    {
+        int lastValue = 0;
+        SmallFunction<void()> function([count = 0, &lastValue]() mutable { lastValue = ++count; });
+        function();
+        function();
+        REQUIRE(lastValue == 2);
+    }
+
+    SUBCASE("Can store move-only callables")
+    {
+        auto pointer = std::make_unique<int>(5);
+        SmallFunction<int()> function([pointer = std::move(pointer)]() { return *pointer; });
+        REQUIRE(function() == 5);
+    }
+
+    SUBCASE("Moving a SmallFunction moves the callable")
+    {
+        auto shared = std::make_shared<int>(1);
+        SmallFunction<int()> function([shared]() { return *shared; });
+        REQUIRE(shared.use_count() == 2);
+
+        SmallFunction<int()> moved(std::move(function));
+        REQUIRE(shared.use_count() == 2);
+        REQUIRE(moved() == 1);
+
+        SmallFunction<int()> assigned;
+        assigned = std::move(moved);
+        REQUIRE(shared.use_count() == 2);
+        REQUIRE(assigned() == 1);
+
+        assigned.reset();
+        REQUIRE_FALSE(assigned);
+        REQUIRE(shared.use_count() == 1);
+    }
+
+    SUBCASE("Destroying a SmallFunction destroys heap allocated callables")
+    {
+        auto shared = std::make_shared<int>(1);
+        {
+            std::array<int, 32> padding{};
+            SmallFunction<int()> function([shared, padding]() { return *shared + padding[0]; });
+            REQUIRE(shared.use_count() == 2);
+
+            SmallFunction<int()> moved(std::move(function));
+            REQUIRE(shared.use_count() == 2);
+            REQUIRE(moved() == 1);
+        }
+        REQUIRE(shared.use_count() == 1);
+    }
+}